@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "AutoTune.hpp"
+
+namespace autoscaler {
+RelayAutoTune::RelayAutoTune(const Settings& settings, int screen_percentage, const RelayOptions& options)
+    : m_options{ options },
+    m_setpoint{ (settings.usagelowerbound + settings.usageupperbound) / 2.0 },
+    m_center{ screen_percentage }
+{
+    m_options.amplitude = std::max(m_options.amplitude, 1);
+
+    // Both relay levels have to be allowed
+    const auto low = settings.minscreenpercentage + m_options.amplitude;
+    const auto high = std::max(settings.maxscreenpercentage - m_options.amplitude, low);
+    m_center = std::clamp(m_center, low, high);
+}
+
+float RelayAutoTune::progress() const {
+    if (m_done) {
+        return 1.0f;
+    }
+
+    // The first two switches are the transient, then two per cycle
+    const auto needed = 2 + 2 * m_options.cycles + 1;
+    return std::min(static_cast<float>(m_switches.size()) / needed, 1.0f);
+}
+
+int RelayAutoTune::tick(float delta, int usage) {
+    if (m_done) {
+        return screen_percentage();
+    }
+
+    m_time += delta;
+    ++m_frames;
+
+    m_budget.add(delta, usage);
+
+    if (usage != -1 && !m_budget.empty()) {
+        const auto load = static_cast<double>(m_budget.load());
+        m_cycle_min = std::min(m_cycle_min, load);
+        m_cycle_max = std::max(m_cycle_max, load);
+
+        const auto switch_low = m_high && load > m_setpoint + m_options.hysteresis;
+        const auto switch_high = !m_high && load < m_setpoint - m_options.hysteresis;
+
+        if (switch_low || switch_high) {
+            m_high = !m_high;
+            m_switches.push_back(m_time);
+
+            // A full cycle ends on every second switch. The first one started from wherever the scene was.
+            if (m_switches.size() % 2 == 1) {
+                if (m_switches.size() > 3) {
+                    m_swings.push_back(m_cycle_max - m_cycle_min);
+                }
+
+                m_cycle_min = 1000.0;
+                m_cycle_max = 0.0;
+            }
+        }
+    }
+
+    if (static_cast<int>(m_swings.size()) >= m_options.cycles || m_time >= m_options.timeout_seconds) {
+        finish();
+    }
+
+    return screen_percentage();
+}
+
+void RelayAutoTune::finish() {
+    m_done = true;
+    m_result.frame_seconds = m_frames > 0 ? m_time / m_frames : 0.0;
+
+    if (m_swings.empty()) {
+        return;
+    }
+
+    // Timed from the end of the transient cycle to the end of the last measured one
+    const auto first = m_switches[2];
+    const auto last = m_switches[2 + 2 * m_swings.size()];
+    m_result.period_seconds = (last - first) / m_swings.size();
+
+    auto amplitude = 0.0;
+
+    for (const auto swing : m_swings) {
+        amplitude += swing / 2.0;
+    }
+
+    m_result.amplitude = amplitude / m_swings.size();
+
+    // Describing function of a relay with hysteresis
+    const auto h = m_options.hysteresis;
+    const auto a = std::sqrt(std::max(m_result.amplitude * m_result.amplitude - h * h, 1.0));
+    m_result.ultimate_gain = 4.0 * m_options.amplitude / (std::numbers::pi * a);
+}
+
+Settings relay_tuned_settings(const Settings& settings, const RelayResult& result) {
+    if (result.period_seconds <= 0.0 || result.frame_seconds <= 0.0) {
+        return settings;
+    }
+
+    Settings tuned = settings;
+
+    // A quarter period is about the loop's dead time. Decreases wait that long for the reading to
+    // confirm itself, increases twice as long since overshooting up costs missed frames.
+    const auto period_frames = result.period_seconds / result.frame_seconds;
+    tuned.decreaseframesrequired = std::clamp(static_cast<int>(std::lround(period_frames / 4.0)), 1, 60);
+    tuned.increaseframesrequired = std::clamp(static_cast<int>(std::lround(period_frames / 2.0)), 1, 120);
+
+    // Ziegler-Nichols style: well under the ultimate gain, applied to an error of half the band
+    const auto half_band = (settings.usageupperbound - settings.usagelowerbound) / 2.0;
+    const auto step = 0.5 * result.ultimate_gain * half_band;
+    tuned.decreaseresamount = std::clamp(static_cast<int>(std::lround(step)), 1, 10);
+    tuned.increaseresamount = std::clamp(static_cast<int>(std::lround(step / 2.0)), 1, 10);
+
+    return tuned;
+}
+}
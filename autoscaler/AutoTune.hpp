@@ -0,0 +1,67 @@
+#pragma once
+
+#include <vector>
+
+#include "FrameBudget.hpp"
+#include "Settings.hpp"
+
+namespace autoscaler {
+struct RelayOptions {
+    int amplitude{ 5 };         // screen percentage either side of where the experiment starts
+    double hysteresis{ 2.0 };   // the load has to cross the setpoint by this much before the relay switches
+    int cycles{ 4 };            // oscillations measured once the first one has settled
+    double timeout_seconds{ 30.0 };
+};
+
+// What the relay experiment measured
+struct RelayResult {
+    double period_seconds{ 0.0 }; // of the oscillation the relay sustained
+    double amplitude{ 0.0 };      // of the load, in percentage points
+    double ultimate_gain{ 0.0 };  // screen percentage per point of load at which the loop would oscillate on its own
+    double frame_seconds{ 0.0 };  // mean engine delta during the experiment
+};
+
+// Relay feedback auto-tune: switches the screen percentage between two levels whenever the load crosses the
+// middle of the band, which makes the loop oscillate at the period its delays allow. The load is GPU time
+// against the frame budget, so the upper level missing the refresh doesn't stall the relay. Like a calibration
+// sweep it replaces the controller while it runs: feed it every tick and apply what it returns.
+class RelayAutoTune {
+public:
+    RelayAutoTune(const Settings& settings, int screen_percentage, const RelayOptions& options = {});
+
+    // Returns the screen percentage to apply for the next frame
+    int tick(float delta, int usage);
+
+    bool done() const { return m_done; }
+    // False when the load never crossed the setpoint often enough, e.g. in a CPU bound scene
+    bool succeeded() const { return m_done && m_result.period_seconds > 0.0; }
+    // 0 to 1
+    float progress() const;
+    int screen_percentage() const { return m_high ? m_center + m_options.amplitude : m_center - m_options.amplitude; }
+
+    const RelayResult& result() const { return m_result; }
+
+private:
+    void finish();
+
+    RelayOptions m_options;
+    double m_setpoint;
+    int m_center;
+    bool m_high{ true };
+    bool m_done{ false };
+
+    FrameBudget m_budget{};
+    double m_time{ 0.0 };
+    int m_frames{ 0 };
+    std::vector<double> m_switches{};   // times the relay switched
+    std::vector<double> m_swings{};     // peak to peak load of each full cycle
+    double m_cycle_min{ 1000.0 };
+    double m_cycle_max{ 0.0 };
+
+    RelayResult m_result{};
+};
+
+// Frame thresholds and step sizes for the loop the experiment measured. The dwell times follow the
+// oscillation period, which is set by the sensor's delay, and the steps are a fraction of the ultimate gain.
+Settings relay_tuned_settings(const Settings& settings, const RelayResult& result);
+}
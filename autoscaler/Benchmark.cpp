@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "Benchmark.hpp"
+#include "Random.hpp"
+
+namespace autoscaler {
+const std::vector<Metric>& scorecard_metrics() {
+    static const std::vector<Metric> s_metrics{
+        { "convergence s", &Scorecard::convergence_seconds, false },
+        { "oscillations", &Scorecard::oscillations, false },
+        { "over budget %", &Scorecard::over_budget_share, false },
+        { "megapixels", &Scorecard::megapixels, true },
+        { "changes", &Scorecard::changes, false },
+    };
+
+    return s_metrics;
+}
+
+ScorecardBuilder::ScorecardBuilder(double pixels_at_100, double measure_from)
+    : m_pixels_at_100{ pixels_at_100 },
+    m_measure_from{ measure_from }
+{
+}
+
+void ScorecardBuilder::add(double time, double delta, int intervals, int screen_percentage, Action action) {
+    if (time < m_measure_from) {
+        return;
+    }
+
+    if (screen_percentage != m_last_screen_percentage) {
+        m_trajectory.emplace_back(time, screen_percentage);
+        m_last_screen_percentage = screen_percentage;
+    }
+
+    ++m_frames;
+    m_seconds += delta;
+    m_end_time = time + delta;
+    m_missed_frames += intervals > 1 ? 1 : 0;
+
+    const auto scale = screen_percentage / 100.0;
+    m_megapixel_seconds += m_pixels_at_100 * scale * scale / 1'000'000.0 * delta;
+
+    if (action != Action::None) {
+        ++m_changes;
+
+        if (m_last_action != Action::None && action != m_last_action) {
+            ++m_oscillations;
+        }
+
+        m_last_action = action;
+    }
+}
+
+Scorecard ScorecardBuilder::finish() const {
+    Scorecard card{};
+
+    if (m_frames == 0) {
+        return card;
+    }
+
+    card.over_budget_share = static_cast<double>(m_missed_frames) / m_frames;
+    card.megapixels = m_seconds > 0.0 ? m_megapixel_seconds / m_seconds : 0.0;
+    card.changes = m_changes;
+    card.oscillations = m_oscillations;
+
+    // Settled from the first point after which resolution never again strays from where it ended
+    const auto final_screen_percentage = m_trajectory.back().second;
+    auto settled_at = m_trajectory.front().first;
+
+    for (auto it = m_trajectory.rbegin(); it != m_trajectory.rend(); ++it) {
+        if (std::abs(it->second - final_screen_percentage) > SETTLED_TOLERANCE) {
+            // the change after this one brought it into tolerance for good
+            settled_at = it == m_trajectory.rbegin() ? m_end_time : std::prev(it)->first;
+            break;
+        }
+    }
+
+    card.convergence_seconds = settled_at - m_trajectory.front().first;
+    return card;
+}
+
+std::vector<Scenario> standard_scenarios(const PlantParams& plant) {
+    std::vector<Scenario> scenarios{};
+
+    // every scenario scripts its own scene on top of the given plant
+    auto base = plant;
+    base.scene = { SceneSegment{} };
+    base.ramp_scene = false;
+
+    {
+        Scenario s{ "cold_start", base };
+        s.seconds = 120.0;
+        scenarios.push_back(s);
+    }
+
+    {
+        Scenario s{ "steady", base };
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        // big enough to push the frame past one interval, where vsync hides how busy the GPU is
+        Scenario s{ "load_spike", base };
+        s.plant.scene = { { 0.0, 1.0 }, { 60.0, 1.6 } };
+        s.seconds = 180.0;
+        s.measure_from = 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        Scenario s{ "load_ramp", base };
+        s.plant.scene = { { 0.0, 1.0 }, { 60.0, 1.0 }, { 180.0, 1.6 } };
+        s.plant.ramp_scene = true;
+        s.measure_from = 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        // the game thread can't keep up, GPU usage falls no matter the resolution
+        Scenario s{ "cpu_bound", base };
+        s.plant.scene = { { 0.0, 1.0 }, { 60.0, 1.0, 14.0 }, { 120.0, 1.0 } };
+        s.seconds = 180.0;
+        s.measure_from = 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        // the runtime drops to half rate, halving GPU usage for the same resolution
+        Scenario s{ "half_rate", base };
+        s.plant.scene = { { 0.0, 1.0 }, { 60.0, 1.0, -1.0, 2 } };
+        s.seconds = 180.0;
+        s.measure_from = 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        // a cutscene locked to 30 fps, the GPU idles whatever the resolution until play resumes
+        Scenario s{ "cutscene", base };
+        s.plant.scene = { { 0.0, 1.0 }, { 60.0, 1.0, 1000.0 / 30.0 }, { 120.0, 1.0 } };
+        s.seconds = 180.0;
+        s.measure_from = 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        // shader compilation and streaming, spikes that no resolution would have avoided
+        Scenario s{ "hitches", base };
+        s.plant.hitch_rate = 0.5;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    {
+        Scenario s{ "noisy_sensor", base };
+        s.plant.noise = std::max(s.plant.noise, 0.05);
+        s.plant.sensor_noise = 5.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    // the scene the plant came with, e.g. one identified from a game's traces
+    if (plant.scene.size() > 1) {
+        Scenario s{ "plant_scene", plant };
+        s.seconds = plant.scene.back().start_seconds + 60.0;
+        s.start_screen_percentage = 85;
+        scenarios.push_back(s);
+    }
+
+    return scenarios;
+}
+
+Scorecard run_scenario(const Scenario& scenario, const Settings& settings, std::uint64_t seed) {
+    auto plant = scenario.plant;
+    plant.seed = seed;
+
+    ScorecardBuilder builder{ plant.pixels_at_100, scenario.measure_from };
+
+    simulate(plant, settings, scenario.seconds, scenario.start_screen_percentage, [&](const SimFrame& frame, const Decision& decision) {
+        builder.add(frame.time, frame.delta, frame.intervals, frame.screen_percentage, decision.action);
+    });
+
+    return builder.finish();
+}
+
+std::vector<Scorecard> score_trace(const std::uint8_t* data, size_t size, const Settings& settings, double block_seconds, double pixels_at_100) {
+    std::vector<Scorecard> blocks{};
+    ScorecardBuilder builder{ pixels_at_100, 0.0 };
+    double block_end = block_seconds;
+
+    replay_trace(data, size, settings, settings, [&](const ReplayTick& tick) {
+        if (tick.time >= block_end) {
+            blocks.push_back(builder.finish());
+            builder = ScorecardBuilder{ pixels_at_100, block_end };
+            block_end += block_seconds;
+        }
+
+        builder.add(tick.time, tick.delta, tick.missed_frames + 1, tick.screen_percentage, tick.decision.action);
+    });
+
+    // a tail shorter than half a block would only add noise to the resample
+    if (builder.seconds() > 0.0 && (builder.seconds() >= block_seconds * 0.5 || blocks.empty())) {
+        blocks.push_back(builder.finish());
+    }
+
+    return blocks;
+}
+
+ConfidenceInterval bootstrap_mean(const std::vector<double>& values, int resamples, double confidence, std::uint64_t seed) {
+    ConfidenceInterval result{};
+
+    if (values.empty()) {
+        return result;
+    }
+
+    double sum = 0.0;
+    for (const auto v : values) {
+        sum += v;
+    }
+
+    result.mean = sum / values.size();
+
+    if (values.size() == 1 || resamples <= 0) {
+        result.low = result.high = result.mean;
+        return result;
+    }
+
+    Random random{ seed };
+
+    std::vector<double> means(static_cast<size_t>(resamples));
+
+    for (auto& mean : means) {
+        double resampled = 0.0;
+
+        for (size_t i = 0; i < values.size(); ++i) {
+            resampled += values[random.below(values.size())];
+        }
+
+        mean = resampled / values.size();
+    }
+
+    std::sort(means.begin(), means.end());
+
+    const auto tail = (1.0 - confidence) / 2.0;
+    const auto at = [&](double q) {
+        return means[std::min(means.size() - 1, static_cast<size_t>(q * (means.size() - 1) + 0.5))];
+    };
+
+    result.low = at(tail);
+    result.high = at(1.0 - tail);
+    return result;
+}
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Replay.hpp"
+#include "Simulator.hpp"
+
+namespace autoscaler {
+// How well a controller did over one run
+struct Scorecard {
+    double convergence_seconds{ 0.0 }; // until resolution stayed near where the run ended up
+    double oscillations{ 0.0 };        // changes that reversed the direction of the previous one
+    double over_budget_share{ 0.0 };   // fraction of frames that missed their interval
+    double megapixels{ 0.0 };          // average rendered megapixels per frame
+    double changes{ 0.0 };
+};
+
+struct Metric {
+    const char* name;
+    double Scorecard::*value;
+    bool higher_is_better;
+};
+
+// Every scorecard metric, in display order
+const std::vector<Metric>& scorecard_metrics();
+
+// Builds a Scorecard one tick at a time. Only ticks from measure_from onwards count.
+class ScorecardBuilder {
+public:
+    ScorecardBuilder(double pixels_at_100, double measure_from = 0.0);
+
+    void add(double time, double delta, int intervals, int screen_percentage, Action action);
+    Scorecard finish() const;
+
+    double seconds() const { return m_seconds; } // measured so far
+
+private:
+    static constexpr int SETTLED_TOLERANCE = 3; // screen percentage points
+
+    double m_pixels_at_100;
+    double m_measure_from;
+    double m_seconds{ 0.0 };
+    double m_megapixel_seconds{ 0.0 };
+    int m_frames{ 0 };
+    int m_missed_frames{ 0 };
+    int m_changes{ 0 };
+    int m_oscillations{ 0 };
+    Action m_last_action{ Action::None };
+    double m_end_time{ 0.0 };
+    int m_last_screen_percentage{ -1 };
+    std::vector<std::pair<double, int>> m_trajectory{}; // (time, screen percentage) at each change
+};
+
+// A scripted situation for the simulator
+struct Scenario {
+    std::string name;
+    PlantParams plant{};
+    double seconds{ 300.0 };
+    double measure_from{ 0.0 }; // when the interesting part starts, e.g. the moment of a load spike
+    int start_screen_percentage{ 50 };
+};
+
+// cold start, steady scene, sudden load spike, slow load ramp, CPU bound stretch,
+// half rate switch and noisy sensor, all on the given plant. A plant with a scene of its
+// own also gets a plant_scene scenario that plays it.
+std::vector<Scenario> standard_scenarios(const PlantParams& plant = {});
+
+Scorecard run_scenario(const Scenario& scenario, const Settings& settings, std::uint64_t seed);
+
+// Replays a trace and scores it in blocks of block_seconds, so traces can be bootstrapped like seeds
+std::vector<Scorecard> score_trace(const std::uint8_t* data, size_t size, const Settings& settings, double block_seconds = 60.0,
+    double pixels_at_100 = PlantParams{}.pixels_at_100);
+
+struct ConfidenceInterval {
+    double mean{ 0.0 };
+    double low{ 0.0 };
+    double high{ 0.0 };
+};
+
+// Percentile bootstrap of the mean, 95% by default. Deterministic for a seed.
+ConfidenceInterval bootstrap_mean(const std::vector<double>& values, int resamples = 2000, double confidence = 0.95,
+    std::uint64_t seed = 1);
+}
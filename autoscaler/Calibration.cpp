@@ -0,0 +1,183 @@
+#include <algorithm>
+
+#include "Calibration.hpp"
+
+namespace autoscaler {
+double CostTable::gpu_ms_at(double screen_percentage) const {
+    if (points.empty()) {
+        return 0.0;
+    }
+
+    if (points.size() == 1) {
+        return points.front().gpu_ms;
+    }
+
+    // The segment containing screen_percentage, or the first/last one outside the measured range
+    size_t upper = 1;
+
+    while (upper + 1 < points.size() && points[upper].screen_percentage < screen_percentage) {
+        ++upper;
+    }
+
+    const auto& a = points[upper - 1];
+    const auto& b = points[upper];
+    const auto t = (screen_percentage - a.screen_percentage) / static_cast<double>(b.screen_percentage - a.screen_percentage);
+    return std::max(a.gpu_ms + t * (b.gpu_ms - a.gpu_ms), 0.0);
+}
+
+int CostTable::screen_percentage_for(double gpu_ms) const {
+    if (points.empty()) {
+        return 0;
+    }
+
+    int result = points.front().screen_percentage;
+    double highest = 0.0;
+
+    for (int sp = points.front().screen_percentage; sp <= points.back().screen_percentage; ++sp) {
+        highest = std::max(highest, gpu_ms_at(sp));
+
+        if (highest > gpu_ms) {
+            break;
+        }
+
+        result = sp;
+    }
+
+    return result;
+}
+
+bool apply_cost_table(const nlohmann::json& j, CostTable& table) {
+    if (!j.is_object() || !j.contains("points") || !j["points"].is_array()) {
+        return false;
+    }
+
+    CostTable result{};
+
+    for (const auto& entry : j["points"]) {
+        if (!entry.is_object() || !entry.contains("screenpercentage") || !entry["screenpercentage"].is_number()
+            || !entry.contains("gpums") || !entry["gpums"].is_number()) {
+            return false;
+        }
+
+        CostPoint point{};
+        point.screen_percentage = entry["screenpercentage"];
+        point.gpu_ms = entry["gpums"];
+
+        if (entry.contains("framems") && entry["framems"].is_number()) {
+            point.frame_ms = entry["framems"];
+        }
+
+        if (entry.contains("usage") && entry["usage"].is_number()) {
+            point.usage = entry["usage"];
+        }
+
+        result.points.push_back(point);
+    }
+
+    std::sort(result.points.begin(), result.points.end(),
+        [](const CostPoint& a, const CostPoint& b) { return a.screen_percentage < b.screen_percentage; });
+
+    // Two entries for one level would make a zero width segment
+    const auto same_level = [](const CostPoint& a, const CostPoint& b) { return a.screen_percentage == b.screen_percentage; };
+    result.points.erase(std::unique(result.points.begin(), result.points.end(), same_level), result.points.end());
+
+    table = std::move(result);
+    return true;
+}
+
+nlohmann::json cost_table_to_json(const CostTable& table) {
+    auto points = nlohmann::json::array();
+
+    for (const auto& point : table.points) {
+        nlohmann::json entry;
+        entry["screenpercentage"] = point.screen_percentage;
+        entry["gpums"] = point.gpu_ms;
+        entry["framems"] = point.frame_ms;
+        entry["usage"] = point.usage;
+        points.push_back(entry);
+    }
+
+    nlohmann::json j;
+    j["points"] = points;
+    return j;
+}
+
+CalibrationSweep::CalibrationSweep(const CalibrationOptions& options)
+    : m_options{ options }
+{
+    const auto step = std::max(m_options.step, 1);
+
+    for (int sp = m_options.min_screen_percentage; sp < m_options.max_screen_percentage; sp += step) {
+        m_levels.push_back(sp);
+    }
+
+    m_levels.push_back(std::max(m_options.max_screen_percentage, m_options.min_screen_percentage));
+}
+
+float CalibrationSweep::progress() const {
+    if (done()) {
+        return 1.0f;
+    }
+
+    const auto level_seconds = m_options.settle_seconds + m_options.hold_seconds;
+    const auto within = level_seconds > 0.0 ? std::min(m_elapsed / level_seconds, 1.0) : 1.0;
+    return static_cast<float>((m_level + within) / m_levels.size());
+}
+
+int CalibrationSweep::screen_percentage() const {
+    return m_levels[std::min(m_level, static_cast<int>(m_levels.size()) - 1)];
+}
+
+int CalibrationSweep::tick(float delta, int usage) {
+    if (done()) {
+        return screen_percentage();
+    }
+
+    m_elapsed += delta;
+
+    // Readings taken before the level settled still describe the previous one
+    if (m_elapsed <= m_options.settle_seconds) {
+        return screen_percentage();
+    }
+
+    m_frame_seconds += delta;
+    ++m_frames;
+
+    if (usage != -1) {
+        m_usage_sum += usage;
+        ++m_readings;
+    }
+
+    const auto held = m_elapsed - m_options.settle_seconds;
+
+    // Keep holding until the sensor has said something, but don't wait forever on one that never will
+    if (held >= m_options.hold_seconds && (m_readings > 0 || held >= 4.0 * m_options.hold_seconds)) {
+        finish_level();
+    }
+
+    return screen_percentage();
+}
+
+void CalibrationSweep::finish_level() {
+    if (m_readings > 0 && m_frames > 0) {
+        // Usage times frame time is the GPU's busy time per frame. Unlike usage alone it doesn't
+        // drop when a level misses the refresh and frames start taking two intervals.
+        const auto usage = m_usage_sum / m_readings;
+        const auto frame_ms = m_frame_seconds * 1000.0 / m_frames;
+
+        CostPoint point{};
+        point.screen_percentage = screen_percentage();
+        point.gpu_ms = usage / 100.0 * frame_ms;
+        point.frame_ms = frame_ms;
+        point.usage = static_cast<int>(usage + 0.5);
+        m_table.points.push_back(point);
+    }
+
+    ++m_level;
+    m_elapsed = 0.0;
+    m_frame_seconds = 0.0;
+    m_frames = 0;
+    m_usage_sum = 0.0;
+    m_readings = 0;
+}
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <vector>
+
+#include "json.hpp"
+
+namespace autoscaler {
+// What one screen percentage cost while it was held during a sweep
+struct CostPoint {
+    int screen_percentage{ 0 };
+    double gpu_ms{ 0.0 };   // GPU busy time per frame
+    double frame_ms{ 0.0 }; // mean engine delta
+    int usage{ -1 };        // mean GPU usage in percent
+};
+
+// Measured GPU cost per screen percentage for one game and headset resolution, sorted by screen percentage
+struct CostTable {
+    std::vector<CostPoint> points{};
+
+    bool empty() const { return points.empty(); }
+
+    // Interpolated between the measured levels, outside them the nearest segment is extended
+    double gpu_ms_at(double screen_percentage) const;
+
+    // The highest screen percentage whose cost stays within gpu_ms, limited to the measured range.
+    // Noisy levels that cost less than a lower one are treated as costing the same.
+    int screen_percentage_for(double gpu_ms) const;
+};
+
+bool apply_cost_table(const nlohmann::json& j, CostTable& table);
+nlohmann::json cost_table_to_json(const CostTable& table);
+
+struct CalibrationOptions {
+    int min_screen_percentage{ 50 };
+    int max_screen_percentage{ 100 };
+    int step{ 10 };
+    double settle_seconds{ 1.0 }; // covers the change hitch, NVML's sampling period and its delay
+    double hold_seconds{ 2.0 };
+};
+
+// Steps the screen percentage from min to max and measures each level. While it runs it replaces the
+// controller: feed it every tick and apply what it returns.
+class CalibrationSweep {
+public:
+    CalibrationSweep(const CalibrationOptions& options = {});
+
+    // Returns the screen percentage to apply for the next frame
+    int tick(float delta, int usage);
+
+    bool done() const { return m_level >= static_cast<int>(m_levels.size()); }
+    // 0 to 1
+    float progress() const;
+    int screen_percentage() const;
+
+    const CostTable& table() const { return m_table; }
+
+private:
+    void finish_level();
+
+    CalibrationOptions m_options;
+    std::vector<int> m_levels{};
+    int m_level{ 0 };
+    double m_elapsed{ 0.0 };
+
+    double m_frame_seconds{ 0.0 };
+    int m_frames{ 0 };
+    double m_usage_sum{ 0.0 };
+    int m_readings{ 0 };
+
+    CostTable m_table{};
+};
+}
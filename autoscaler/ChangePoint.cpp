@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <cmath>
+
+#include "ChangePoint.hpp"
+
+namespace autoscaler {
+namespace {
+// The mean follows within a few seconds, the spread more slowly so a shift can't inflate it before it fires
+constexpr double MEAN_RATE = 0.5;
+constexpr double SPREAD_RATE = 0.2;
+}
+
+ChangeDetector::ChangeDetector(const Options& options)
+    : m_options{ options }
+{
+}
+
+void ChangeDetector::rearm() {
+    m_started = false;
+    m_up = 0.0;
+    m_down = 0.0;
+    m_ignore = m_options.ignore_seconds;
+}
+
+bool ChangeDetector::add(float seconds, double value) {
+    if (m_ignore > 0.0f) {
+        m_ignore -= seconds;
+        return false;
+    }
+
+    if (!m_started) {
+        m_started = true;
+        m_mean = value;
+        return false;
+    }
+
+    // A plain running average at first, so the spread reflects the signal before the first judgement
+    if (m_observed < m_options.warmup_seconds) {
+        m_observed += seconds;
+        const auto weight = seconds / m_observed;
+        m_spread += weight * (std::abs(value - m_mean) - m_spread);
+        m_mean += weight * (value - m_mean);
+        return false;
+    }
+
+    const auto spread = std::max(m_spread, m_options.min_spread);
+    const auto z = std::clamp((value - m_mean) / spread, -m_options.cap, m_options.cap);
+
+    m_up = std::max(0.0, m_up + (z - m_options.allowance) * seconds);
+    m_down = std::max(0.0, m_down + (-z - m_options.allowance) * seconds);
+
+    if (m_up > m_options.threshold || m_down > m_options.threshold) {
+        m_mean = value;
+        m_up = 0.0;
+        m_down = 0.0;
+        return true;
+    }
+
+    const auto mean_weight = std::min(MEAN_RATE * seconds, 1.0);
+    const auto spread_weight = std::min(SPREAD_RATE * seconds, 1.0);
+    m_spread += spread_weight * (std::abs(value - m_mean) - m_spread);
+    m_mean += mean_weight * (value - m_mean);
+    return false;
+}
+}
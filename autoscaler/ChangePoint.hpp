@@ -0,0 +1,42 @@
+#pragma once
+
+namespace autoscaler {
+// Two-sided CUSUM on a noisy signal. Deviations from a slowly tracked mean are scaled by the signal's own
+// spread and summed over time, less an allowance, so noise cancels out while a lasting shift builds up
+// until it crosses the threshold. Weighted by time rather than samples, since readings repeat between
+// NVML samples.
+class ChangeDetector {
+public:
+    struct Options {
+        double allowance{ 1.0 };  // deviations under this many spreads are treated as noise
+        double threshold{ 1.5 };  // spread-seconds of deviation beyond the allowance before firing
+        double cap{ 4.0 };        // deviations are clipped to this many spreads, so a short blip can't fire on its own
+        double min_spread{ 2.0 }; // in the signal's units, so a quiet signal doesn't fire on a blip
+        float ignore_seconds{ 0.3f }; // after rearm(), covers the sensor delay
+        float warmup_seconds{ 1.0f }; // the spread is learned before anything is judged against it
+    };
+
+    ChangeDetector() : ChangeDetector(Options{}) {}
+    explicit ChangeDetector(const Options& options);
+
+    // True on the sample where a shift was detected. The mean then restarts from the new level.
+    bool add(float seconds, double value);
+
+    // Call after changing what the signal measures, e.g. the resolution. The samples that still describe
+    // the old level are skipped and the mean restarts from the first new one.
+    void rearm();
+
+    double mean() const { return m_mean; }
+    double spread() const { return m_spread; }
+
+private:
+    Options m_options;
+    bool m_started{ false };
+    float m_observed{ 0.0f };
+    double m_mean{ 0.0 };
+    double m_spread{ 0.0 };
+    double m_up{ 0.0 };
+    double m_down{ 0.0 };
+    float m_ignore{ 0.0f };
+};
+}
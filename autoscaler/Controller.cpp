@@ -0,0 +1,582 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Controller.hpp"
+
+namespace autoscaler {
+namespace {
+// NVML's sampling period plus its delay, readings taken sooner still describe the previous level
+constexpr float SETTLE_SECONDS = 0.3f;
+// Caps how far one predicted change can go, so a poorly fitted slope can't overshoot by much
+constexpr int MAX_PREDICTED_STEP = 20;
+// How long a probe is watched once the sensor has caught up with it, several NVML periods
+constexpr float PROBE_WINDOW = 1.0f;
+// Time between probes inside the band, doubled by each failure
+constexpr float MIN_PROBE_INTERVAL = 1.0f;
+constexpr float MAX_PROBE_INTERVAL = 60.0f;
+// An overload this soon after a probe is blamed on the probe
+constexpr float PROBATION_SECONDS = 5.0f;
+constexpr int MAX_PROBE_STEP = 10;
+// Re-acquiring gives up and hands back to the policy after this long
+constexpr float REACQUIRE_SECONDS = 3.0f;
+// A frame cap starting drops the load as well, and FrameCapDetector needs a second of frames to tell a
+// cinematic one. Re-acquiring waits this long after a drop before going up.
+constexpr float CAP_RECOGNITION_SECONDS = 1.0f;
+// While damping a limit cycle, usage has to be this many points further under the band per level to increase
+constexpr int WIDEN_PER_LEVEL = 2;
+// A frame this many refresh intervals long missed the refresh, as FrameBudget counts them
+constexpr double MISSED_FRAME = 1.5;
+// Refreshes missed within this long, since the last change, make up the missedframes count
+constexpr float MISSED_WINDOW = 1.0f;
+// No frame making the refresh for this long with the GPU keeping up means the rate itself changed,
+// e.g. the runtime dropped to half rate, and the refresh interval is learned again
+constexpr float RATE_CHANGE_SECONDS = 2.0f;
+// Readings this soon after a frame cap ends still describe capped frames. Covers MISSED_WINDOW too, which
+// holds refreshes missed as the cap started.
+constexpr float CAP_SETTLE_SECONDS = 1.0f;
+// The cascade's outer loop moves the resolution in steps of at least this much, so its slow drift doesn't
+// turn into a change every few frames
+constexpr int MIN_OUTER_STEP = 2;
+
+Controller::Policy policy_from_name(const std::string& name) {
+    if (name == "predictive") {
+        return Controller::Policy::Predictive;
+    }
+
+    if (name == "probe") {
+        return Controller::Policy::Probe;
+    }
+
+    if (name == "cascade") {
+        return Controller::Policy::Cascade;
+    }
+
+    return Controller::Policy::Step;
+}
+
+double pixels(int screen_percentage) {
+    const auto scale = screen_percentage / 100.0;
+    return scale * scale;
+}
+}
+
+Controller::Controller(const Settings& settings, int screen_percentage)
+    : m_settings{ settings },
+    m_policy{ policy_from_name(settings.controller) },
+    m_screen_percentage{ screen_percentage },
+    m_window{ std::max(settings.increasewindowms, settings.decreasewindowms) / 1000.0f },
+    m_frame_p95{ 0.95, settings.tailwindowms / 1000.0f },
+    m_frame_p99{ 0.99, settings.tailwindowms / 1000.0f }
+{
+}
+
+void Controller::set_settings(const Settings& settings) {
+    // Frames from before the filter was switched off would be the median it judges the next hitch by
+    if (settings.hitchfilter != m_settings.hitchfilter) {
+        m_hitch_filter.clear();
+    }
+
+    m_settings = settings;
+    m_policy = policy_from_name(settings.controller);
+    m_window.set_span(std::max(settings.increasewindowms, settings.decreasewindowms) / 1000.0f);
+    m_frame_p95.set_span(settings.tailwindowms / 1000.0f);
+    m_frame_p99.set_span(settings.tailwindowms / 1000.0f);
+}
+
+void Controller::set_cost_table(const CostTable& table) {
+    m_cost_table = table;
+}
+
+// Probing already backs off after each failed probe, and a failed probe is a reversal by design. The
+// cascade's trims and their recovery are reversals by design too.
+bool Controller::damped() const {
+    return m_settings.oscillationdamping && m_policy != Policy::Probe && m_policy != Policy::Cascade;
+}
+
+int Controller::damping() const {
+    return damped() ? m_oscillation.level() : 0;
+}
+
+int Controller::highest() const {
+    const auto ceiling = damped() ? m_oscillation.ceiling() : -1;
+    const auto top = ceiling >= 0 ? std::clamp(ceiling, m_settings.minscreenpercentage, m_settings.maxscreenpercentage) : m_settings.maxscreenpercentage;
+
+    if (!held()) {
+        return top;
+    }
+
+    // Never below where the cap found it, a cap only stops it going higher
+    const auto raise_to = m_capped && m_settings.raiseduringcaps ? uncapped_ceiling() : m_held_level;
+    return std::min(top, std::max(raise_to, m_held_level));
+}
+
+bool Controller::held() const {
+    return m_capped || m_since_cap < CAP_SETTLE_SECONDS;
+}
+
+int Controller::uncapped_ceiling() const {
+    if (m_budget.cost_ms() <= 0.0 || m_vsync.interval_ms() <= 0.0) {
+        return m_screen_percentage;
+    }
+
+    // GPU time scales with the pixel count
+    const auto target_ms = (m_settings.usagelowerbound + m_settings.usageupperbound) / 200.0 * m_vsync.interval_ms();
+    return static_cast<int>(std::floor(m_screen_percentage * std::sqrt(target_ms / m_budget.cost_ms())));
+}
+
+int Controller::calibrated_target(int usage) const {
+    if (!m_settings.usecalibration || m_cost_table.empty() || usage <= 0) {
+        return m_screen_percentage;
+    }
+
+    // The table was measured in one scene, the current reading tells us how much heavier or lighter this one is
+    const auto target_usage = (m_settings.usagelowerbound + m_settings.usageupperbound) / 2.0;
+    const auto target_ms = m_cost_table.gpu_ms_at(m_screen_percentage) * target_usage / usage;
+    return m_cost_table.screen_percentage_for(target_ms);
+}
+
+void Controller::observe(const Sample& sample) {
+    m_budget.add(sample.delta, sample.usage);
+
+    if (sample.delta > 0.0f) {
+        m_frame_p95.push(sample.delta, sample.delta * 1000.0);
+        m_frame_p99.push(sample.delta, sample.delta * 1000.0);
+    }
+
+    if (m_policy == Policy::Predictive && sample.usage != -1 && !m_budget.empty() && m_since_change >= SETTLE_SECONDS) {
+        m_cost_model.add(pixels(m_screen_percentage), m_budget.cost_ms());
+    }
+}
+
+bool Controller::tail_over_budget() const {
+    const auto percentile = m_settings.tailpercentile;
+
+    if (percentile == 0 || m_budget.empty()) {
+        return false;
+    }
+
+    // Enough frames that the percentile isn't just the slowest one
+    const auto& tail = percentile == 99 ? m_frame_p99 : m_frame_p95;
+    const auto needed = static_cast<size_t>(100 / (100 - percentile));
+    return tail.count() >= needed && tail.value() > MISSED_FRAME * m_budget.interval_ms();
+}
+
+bool Controller::missing_refreshes() const {
+    const auto& s = m_settings;
+    return s.missedframes > 0 && m_vsync.quantized() && m_vsync.missed(std::min(m_since_change, MISSED_WINDOW)) >= s.missedframes;
+}
+
+bool Controller::gpu_late() const {
+    return m_budget.cost_ms() / m_vsync.interval_ms() * 100.0 >= m_settings.usageupperbound;
+}
+
+int Controller::predicted_target() const {
+    const auto slope = m_cost_model.per_pixel();
+
+    if (m_cost_model.empty() || slope <= 0.0 || m_budget.empty()) {
+        return m_screen_percentage;
+    }
+
+    // Anchored on the latest reading, so only the slope has to be right and scene changes don't bias it
+    const auto target_ms = (m_settings.usagelowerbound + m_settings.usageupperbound) / 200.0 * m_budget.interval_ms();
+    const auto target_pixels = std::max(pixels(m_screen_percentage) + (target_ms - m_budget.cost_ms()) / slope, 0.0);
+    const auto target = static_cast<int>(std::floor(100.0 * std::sqrt(target_pixels)));
+
+    return std::clamp(target, m_screen_percentage - MAX_PREDICTED_STEP, m_screen_percentage + MAX_PREDICTED_STEP);
+}
+
+void Controller::change(Action action, int screen_percentage, Decision& decision) {
+    m_oscillation.record(action == Action::Increase, m_screen_percentage, screen_percentage);
+    m_screen_percentage = screen_percentage;
+    decision.action = action;
+
+    if (action == Action::Increase) {
+        decision.seconds_since_last = m_since_increase;
+        m_since_increase = 0;
+        m_frames_under_budget = 0;
+    }
+    else {
+        decision.seconds_since_last = m_since_decrease;
+        m_since_decrease = 0;
+        m_frames_over_budget = 0;
+    }
+
+    m_since_change = 0;
+    m_window.clear();
+    m_change_detector.rearm();
+}
+
+Decision Controller::update(const Sample& input) {
+    auto sample = input;
+    auto hitch = Hitch::None;
+
+    // One-off hitches are kept out of everything below, the decision only records them
+    if (m_settings.hitchfilter) {
+        const auto filtered = m_hitch_filter.filter(input.delta, input.usage, m_since_change);
+        sample = { filtered.delta, filtered.usage };
+        hitch = filtered.hitch;
+    }
+
+    m_since_increase += sample.delta;
+    m_since_decrease += sample.delta;
+    m_since_change += sample.delta;
+    m_since_probe += sample.delta;
+    m_since_scene_change += sample.delta;
+    m_oscillation.tick(sample.delta);
+
+    observe(sample);
+
+    Decision decision{};
+    decision.usage = input.usage;
+    decision.hitch = hitch;
+    decision.frame_p95_ms = static_cast<float>(m_frame_p95.value());
+    decision.frame_p99_ms = static_cast<float>(m_frame_p99.value());
+    const auto& s = m_settings;
+
+    // A capped frame isn't a missed refresh, and mustn't teach the detector a new refresh interval. A GPU that
+    // holds frames to n refreshes takes longer than n - 1 of them, one that doesn't isn't what's holding them.
+    // Without a GPU time only a cap the console variables report is taken at its word, a cinematic rate
+    // could as well be the GPU, and missed refreshes are all there is to go by.
+    const auto interval_ms = m_vsync.quantized() ? m_vsync.interval_ms() : 0.0;
+    const auto cost_ms = m_budget.cost_ms();
+    const auto held_to_cap = s.capdetection && m_frame_cap.add(sample.delta, interval_ms);
+    const auto gpu_keeps_up = cost_ms > 0.0 ? cost_ms < m_frame_cap.cap_ms() - interval_ms : m_frame_cap.reported();
+    const auto capped = held_to_cap && gpu_keeps_up;
+
+    if (capped && !held()) {
+        m_held_level = m_screen_percentage;
+    }
+
+    m_capped = capped;
+    m_since_cap = m_capped ? 0.0f : m_since_cap + sample.delta;
+    decision.capped = m_capped;
+
+    decision.missed = m_capped ? 0 : m_vsync.add(sample.delta);
+    m_since_on_time = decision.missed == 0 ? 0.0f : m_since_on_time + sample.delta;
+
+    if (m_since_on_time >= RATE_CHANGE_SECONDS && m_budget.cost_ms() > 0.0 && !gpu_late()) {
+        m_vsync.clear();
+        m_since_on_time = 0.0f;
+    }
+
+    const auto missing = !held() && missing_refreshes();
+
+    if (sample.usage == -1) {
+        // With no sensor at all, missed refreshes are the only sign of overload. One step per window.
+        if (missing && m_budget.cost_ms() <= 0.0 && m_since_change >= MISSED_WINDOW) {
+            decision.band = Band::Over;
+            change(Action::Decrease, std::max(m_screen_percentage - s.decreaseresamount, s.minscreenpercentage), decision);
+        }
+
+        decision.screen_percentage = m_screen_percentage;
+        return decision;
+    }
+
+    // The predictive and probing controllers judge the band by GPU time against the frame budget,
+    // which unlike usage keeps rising once frames miss the refresh
+    auto usage = m_policy != Policy::Step && !m_budget.empty() ? m_budget.load() : sample.usage;
+
+    // Missed frames count as over the band whatever the average says. The estimate covers up to a
+    // window of the past, so straight after a change it only holds back increases.
+    if (tail_over_budget()) {
+        usage = m_since_change >= s.tailwindowms / 1000.0f ? std::max(usage, s.usageupperbound) : std::max(usage, s.usagelowerbound + 1);
+    }
+
+    // Unlike usage, which falls once frames take two intervals, missed refreshes keep saying the GPU is late.
+    // With the GPU idle for part of each interval the game thread or the runtime's rate held frames back
+    // instead, and no resolution would judge that fairly, so it only holds back increases.
+    if (missing) {
+        usage = gpu_late() ? std::max(usage, s.usageupperbound) : std::max(usage, s.usagelowerbound + 1);
+    }
+
+    // A capped GPU idles whatever the resolution, raising it would only show once play resumes, far over
+    // budget. Increases wait, or with raiseduringcaps stop at what uncapped frames could sustain, see highest().
+    if (held() && !(m_capped && s.raiseduringcaps)) {
+        usage = std::max(usage, s.usagelowerbound + 1);
+    }
+
+    m_window.push(sample.delta, static_cast<float>(usage));
+
+    if (usage <= s.usagelowerbound) {
+        decision.band = Band::Under;
+    }
+    else if (usage >= s.usageupperbound) {
+        decision.band = Band::Over;
+    }
+    else {
+        decision.band = Band::Inside;
+    }
+
+    // The load's step into or out of a cap isn't a scene change
+    if (held()) {
+        m_reacquiring = false;
+    }
+    // Judged on budget load whatever the policy, the signal has to keep rising once frames miss the refresh
+    else if (s.changedetection && !m_budget.empty() && m_change_detector.add(sample.delta, m_budget.load())) {
+        decision.scene_change = true;
+        m_reacquiring = true;
+        m_since_scene_change = 0;
+
+        // What the probes learned was about the old scene
+        m_probe_from = -1;
+        m_committed_from = -1;
+        m_probe_successes = 0;
+        m_probe_interval = MIN_PROBE_INTERVAL;
+
+        // Nor is a cycle between the old scene's levels worth damping
+        m_oscillation.clear();
+    }
+
+    // Refreshes the GPU is late for say the load shifted well before the detector can, which a change
+    // of our own would only rearm
+    if (s.changedetection && !m_reacquiring && missing && gpu_late()) {
+        m_reacquiring = true;
+        m_since_scene_change = 0;
+    }
+
+    // Re-acquiring stands in for the policy until the load is back in the band
+    if (!m_reacquiring || !reacquire(decision)) {
+        if (m_policy == Policy::Probe) {
+            probe(usage, decision);
+        }
+        else if (m_policy == Policy::Cascade) {
+            cascade(sample.delta, usage, decision);
+        }
+        else {
+            step(usage, decision);
+        }
+    }
+
+    // The limits can be moved from the UI or a reload while we're outside them
+    m_screen_percentage = std::clamp(m_screen_percentage, s.minscreenpercentage, s.maxscreenpercentage);
+
+    decision.screen_percentage = m_screen_percentage;
+    decision.damping = damping();
+    return decision;
+}
+
+bool Controller::reacquire(Decision& decision) {
+    const auto& s = m_settings;
+    const auto load = m_budget.load();
+
+    if (!s.changedetection || m_budget.empty() || m_since_scene_change >= REACQUIRE_SECONDS
+        || (load > s.usagelowerbound && load < s.usageupperbound)) {
+        m_reacquiring = false;
+        return false;
+    }
+
+    // One jump per sensor delay, readings in between still describe the previous level
+    if (m_since_change < SETTLE_SECONDS) {
+        return true;
+    }
+
+    // GPU time goes roughly with pixel count, scale that by how far the load is from the middle of the band
+    const auto middle = (s.usagelowerbound + s.usageupperbound) / 2.0;
+    const auto target = static_cast<int>(m_screen_percentage * std::sqrt(middle / std::max(load, 1)));
+
+    if (load >= s.usageupperbound && m_screen_percentage > s.minscreenpercentage) {
+        const auto lowest = std::max(m_screen_percentage - MAX_PREDICTED_STEP, s.minscreenpercentage);
+        change(Action::Decrease, std::max(std::min(target, m_screen_percentage - s.decreaseresamount), lowest), decision);
+    }
+    else if (load <= s.usagelowerbound && m_screen_percentage < highest()) {
+        if (m_since_scene_change < CAP_RECOGNITION_SECONDS) {
+            return true;
+        }
+
+        const auto highest = std::min(m_screen_percentage + MAX_PREDICTED_STEP, this->highest());
+        change(Action::Increase, std::min(std::max(target, m_screen_percentage + s.increaseresamount), highest), decision);
+
+        // Load also drops when the CPU holds frames back, in menus and loading screens, where more pixels
+        // cost nothing until it stops. One jump, the policy's slower increases carry on from there.
+        m_reacquiring = false;
+    }
+
+    return true;
+}
+
+bool Controller::window_agrees(int window_ms, bool under, int bound) const {
+    const auto span = window_ms / 1000.0f;
+
+    // Readings from before the last change don't count, the window has to fill again. At high tick rates
+    // the ring fills before the span does, a full ring of readings is as much as it can judge by.
+    if (m_window.seconds() < span && !m_window.full()) {
+        return false;
+    }
+
+    const auto share = under ? m_window.share_at_or_below(static_cast<float>(bound), span) : m_window.share_at_or_above(static_cast<float>(bound), span);
+    return share * 100.0f >= m_settings.windowshare;
+}
+
+void Controller::step(int usage, Decision& decision) {
+    const auto& s = m_settings;
+    const auto predictive = m_policy == Policy::Predictive;
+    const auto settled = !predictive || m_since_change >= SETTLE_SECONDS;
+
+    // Damping a limit cycle: increases need more margin and a longer dwell, and may be pinned below the cycle
+    const auto lower = s.usagelowerbound - WIDEN_PER_LEVEL * damping();
+    const auto dwell = 1 << damping();
+    const auto highest = this->highest();
+
+    if (usage <= lower && m_screen_percentage < highest) {
+        ++m_frames_under_budget;
+    }
+    else {
+        m_frames_under_budget = 0;
+    }
+
+    if (usage >= s.usageupperbound && m_screen_percentage > s.minscreenpercentage) {
+        ++m_frames_over_budget;
+    }
+    else {
+        m_frames_over_budget = 0;
+    }
+
+    // An unbroken run of frames, or most of a time window so one stray reading doesn't restart the wait
+    const auto increase = s.increasewindowms > 0 ? window_agrees(s.increasewindowms * dwell, true, lower) : m_frames_under_budget > s.increaseframesrequired * dwell;
+    const auto decrease = s.decreasewindowms > 0 ? window_agrees(s.decreasewindowms, false, s.usageupperbound) : m_frames_over_budget > s.decreaseframesrequired;
+
+    // With a window, a cost table jump goes by its trimmed mean rather than the latest reading
+    const auto level = [&](int window_ms) {
+        return window_ms > 0 ? static_cast<int>(m_window.trimmed_mean(window_ms / 1000.0f, 0.1f) + 0.5f) : usage;
+    };
+
+    // increase infrequently and by a small amount, to prevent too many hitches
+    // decrease sooner and by more, so we're not below target too long
+    if (increase && settled && m_screen_percentage < highest) {
+        const auto step = m_screen_percentage + s.increaseresamount;
+        const auto target = predictive ? predicted_target() : calibrated_target(level(s.increasewindowms));
+        change(Action::Increase, std::min(std::max(step, target), highest), decision);
+    }
+    else if (decrease && settled && m_screen_percentage > s.minscreenpercentage) {
+        const auto step = m_screen_percentage - s.decreaseresamount;
+        const auto target = predictive ? predicted_target() : calibrated_target(level(s.decreasewindowms));
+        change(Action::Decrease, std::max(std::min(step, target), s.minscreenpercentage), decision);
+    }
+}
+
+void Controller::probe(int usage, Decision& decision) {
+    const auto& s = m_settings;
+    const auto settled = m_since_change >= SETTLE_SECONDS;
+
+    if (usage >= s.usageupperbound) {
+        ++m_frames_over_budget;
+    }
+    else {
+        m_frames_over_budget = 0;
+    }
+
+    const auto overloaded = m_frames_over_budget > s.decreaseframesrequired && settled;
+
+    if (m_probe_from >= 0) {
+        if (!overloaded && m_since_change < SETTLE_SECONDS + PROBE_WINDOW) {
+            return;
+        }
+
+        // A probe that survived its window is kept, but stays on probation for a while
+        m_committed_from = m_probe_from;
+        m_probe_from = -1;
+        m_since_probe = 0;
+
+        if (!overloaded) {
+            ++m_probe_successes;
+            return;
+        }
+    }
+
+    if (overloaded && m_screen_percentage > s.minscreenpercentage) {
+        // Every failure makes the next probe wait twice as long, so a scene at its limit is left alone
+        m_probe_successes = 0;
+        m_probe_interval = std::min(m_probe_interval * 2.0f, MAX_PROBE_INTERVAL);
+
+        // Soon after a probe it was the probe's fault, go straight back to where it started
+        if (m_committed_from >= 0 && m_since_probe < PROBATION_SECONDS) {
+            change(Action::Decrease, std::max(std::min(m_committed_from, m_screen_percentage - 1), s.minscreenpercentage), decision);
+            m_committed_from = -1;
+            m_since_probe = 0;
+            return;
+        }
+
+        // Otherwise the scene got heavier. Back off multiplicatively, scaling the pixel count by how far
+        // over the middle of the band we are.
+        const auto share = (s.usagelowerbound + s.usageupperbound) / 2.0 / usage;
+        const auto backoff = static_cast<int>(m_screen_percentage * std::sqrt(share));
+        change(Action::Decrease, std::max(std::min(m_screen_percentage - s.decreaseresamount, backoff), s.minscreenpercentage), decision);
+        m_committed_from = -1;
+        m_since_probe = 0;
+        return;
+    }
+
+    if (!settled || usage >= s.usageupperbound || m_screen_percentage >= highest()) {
+        return;
+    }
+
+    // Well under the band there's nothing to learn from waiting, and the scene has clearly changed since
+    // the last failure. Probes there grow while they keep succeeding, like a congestion window in slow
+    // start. Inside the band they stay at the configured amount and wait out the probe interval.
+    const auto under = usage <= s.usagelowerbound;
+
+    if (under) {
+        m_probe_interval = MIN_PROBE_INTERVAL;
+    }
+    else if (m_since_probe < m_probe_interval) {
+        return;
+    }
+
+    const auto amount = under ? std::min(s.increaseresamount << std::min(m_probe_successes, 4), MAX_PROBE_STEP) : s.increaseresamount;
+    m_probe_from = m_screen_percentage;
+    change(Action::Increase, std::min(m_screen_percentage + amount, highest()), decision);
+}
+
+void Controller::cascade(float delta, int usage, Decision& decision) {
+    const auto& s = m_settings;
+
+    // Something else moved the resolution, re-acquiring or the limits, so both loops start from there
+    if (m_screen_percentage != m_cascade_applied) {
+        m_baseline = m_screen_percentage;
+        m_trim = 0;
+        m_applied_trim = 0;
+    }
+
+    // Inner loop: a run of missed refreshes takes a bounded trim off straight away, and once they stop for
+    // a while it all goes back in one change. Engine deltas arrive every frame, usage only describes the
+    // frames before last.
+    const auto missed = !held() && !m_budget.empty() && delta * 1000.0 > MISSED_FRAME * m_budget.interval_ms();
+    m_missed_in_a_row = missed ? m_missed_in_a_row + 1 : 0;
+    m_since_trim += delta;
+
+    if (m_missed_in_a_row >= s.innerframes && m_trim > -s.innermaxtrim) {
+        m_trim = std::max(m_trim - s.innerstep, -s.innermaxtrim);
+        m_missed_in_a_row = 0;
+        m_since_trim = 0.0f;
+    }
+    else if (m_trim < 0 && m_since_trim * 1000.0f >= s.innerrecoveryms) {
+        m_trim = 0;
+        m_since_trim = 0.0f;
+    }
+
+    // Outer loop: outside the band the baseline closes on the level whose pixel count would put the load in
+    // the middle, over about outertimems. It doesn't climb while the inner loop is holding it down, and
+    // readings of the previous level are left alone.
+    const auto over = usage >= s.usageupperbound;
+    const auto under = usage <= s.usagelowerbound && m_trim == 0;
+
+    if ((over || under) && usage > 0 && m_since_change >= SETTLE_SECONDS) {
+        const auto middle = (s.usagelowerbound + s.usageupperbound) / 2.0;
+        const auto target = m_screen_percentage * std::sqrt(middle / usage) - m_trim;
+        const auto share = std::min(delta * 1000.0 / std::max(s.outertimems, 1), 1.0);
+        m_baseline += share * (target - m_baseline);
+    }
+
+    m_baseline = std::clamp(m_baseline, static_cast<double>(s.minscreenpercentage), static_cast<double>(highest()));
+
+    const auto applied = std::clamp(static_cast<int>(std::lround(m_baseline)) + m_trim, s.minscreenpercentage, highest());
+    const auto trimmed = m_trim != m_applied_trim;
+
+    if (applied != m_screen_percentage && (trimmed || std::abs(applied - m_screen_percentage) >= MIN_OUTER_STEP)) {
+        change(applied > m_screen_percentage ? Action::Increase : Action::Decrease, applied, decision);
+    }
+
+    m_cascade_applied = m_screen_percentage;
+    m_applied_trim = m_trim;
+}
+}
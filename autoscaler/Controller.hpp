@@ -0,0 +1,187 @@
+#pragma once
+
+#include "Calibration.hpp"
+#include "ChangePoint.hpp"
+#include "CostModel.hpp"
+#include "FrameBudget.hpp"
+#include "FrameCap.hpp"
+#include "HitchFilter.hpp"
+#include "Oscillation.hpp"
+#include "Quantile.hpp"
+#include "Settings.hpp"
+#include "TimeWindow.hpp"
+#include "Vsync.hpp"
+
+namespace autoscaler {
+// One engine tick's worth of input
+struct Sample {
+    float delta{ 0.0f }; // engine delta in seconds
+    int usage{ -1 };     // GPU usage in percent, -1 when the sensor had no reading
+};
+
+enum class Action {
+    None,
+    Increase,
+    Decrease,
+};
+
+// Where the latest reading sits relative to the usage band
+enum class Band {
+    NoReading,
+    Under,
+    Inside,
+    Over,
+};
+
+struct Decision {
+    Action action{ Action::None };
+    Band band{ Band::NoReading };
+    int screen_percentage{ 0 };
+    float seconds_since_last{ 0.0f }; // time since the previous change in the same direction
+    int usage{ -1 };      // as the sensor read it, even when a hitch kept it from the controller
+    Hitch hitch{ Hitch::None };
+    bool scene_change{ false }; // the GPU cost shifted and the controller started re-acquiring the band
+    int damping{ 0 };           // how hard a limit cycle is being damped, 0 when it isn't
+    int missed{ 0 };            // refreshes this frame missed, going by the deltas
+    bool capped{ false };       // frames are held to an engine frame cap
+    // Engine frame time over about the last tailwindowms
+    float frame_p95_ms{ 0.0f };
+    float frame_p99_ms{ 0.0f };
+};
+
+// The usage of recent ticks, enough for MAX_WINDOW_MS at refresh rates up to about 200 Hz
+using UsageWindow = TimeWindow<1024>;
+
+// Keeps GPU usage between the lower and upper bound by moving the screen percentage.
+// Increases once usage has stayed at or under the lower bound for increaseframesrequired
+// consecutive samples, decreases once it has stayed at or over the upper bound for
+// decreaseframesrequired samples. With increasewindowms or decreasewindowms set, the run of samples is
+// replaced by a share of that much recent time, so a single stray reading doesn't restart the wait.
+// With a calibrated cost table, and usecalibration set, a change jumps straight to the level the table
+// says brings usage to the middle of the band, moving at least the configured step.
+// The "predictive" controller does the same from a cost curve it learns as it goes, and waits out the
+// sensor's delay after each change instead of acting on readings of the previous level.
+// The "probe" controller works like congestion control: it raises the resolution a little, watches whether
+// that overloads the GPU, and keeps the step or goes straight back. Probes grow while they succeed and come
+// less often after each failure, and an overload it didn't cause takes off a share of the resolution.
+// With hitchfilter set, one-off spikes in frame time or usage are left out before any of them sees a sample.
+// With capdetection set, frames held to an engine frame cap, such as a cutscene's 30 fps, hold the resolution
+// where it is, since the idle GPU says nothing about uncapped play. raiseduringcaps lets it rise as far as the
+// GPU time of uncapped frames would stay in the band.
+// With missedframes set, refreshes missed going by the engine deltas count as over the band for every
+// policy, and with no usage reading at all they're the only thing that moves the resolution.
+// The "cascade" controller runs two loops. The inner one trims the resolution within a few frames of missed
+// refreshes and gives it back in one change once they stop; the outer one moves the baseline toward the middle of the band
+// over seconds.
+// With changedetection set, a lasting shift in GPU load switches from the policy to re-acquiring the band:
+// jumps sized by how far out of the band the load is, one per sensor delay, until it's back inside.
+// With oscillationdamping set, the screen percentage cycling up and down makes the step and predictive
+// controllers' increases wait longer and need more margin, and at higher levels caps them at the bottom of
+// the cycle, until things stay quiet.
+// With tailpercentile set, any of them also treats a tail of frames missing the refresh as over the band.
+class Controller {
+public:
+    enum class Policy {
+        Step,
+        Predictive,
+        Probe,
+        Cascade,
+    };
+
+    Controller(const Settings& settings = {}, int screen_percentage = 50);
+
+    Decision update(const Sample& sample);
+
+    // Takes effect from the next update, the frame counters are kept
+    void set_settings(const Settings& settings);
+    const Settings& settings() const { return m_settings; }
+
+    // An empty table goes back to stepping
+    void set_cost_table(const CostTable& table);
+    const CostTable& cost_table() const { return m_cost_table; }
+    const CostModel& cost_model() const { return m_cost_model; }
+
+    int screen_percentage() const { return m_screen_percentage; }
+    Policy policy() const { return m_policy; }
+    // Up and down cycles of the screen percentage seen so far
+    int cycles() const { return m_oscillation.cycles(); }
+    // The refresh interval and missed refreshes as the engine deltas show them
+    const VsyncDetector& vsync() const { return m_vsync; }
+    // Caps set through console variables, t.MaxFPS and rhi.SyncInterval, 0 when they don't cap anything.
+    // Cutscene caps are recognized from the deltas without them.
+    void set_engine_caps(float max_fps, int sync_interval) { m_frame_cap.set_engine_caps(max_fps, sync_interval); }
+    const FrameCapDetector& frame_cap() const { return m_frame_cap; }
+    // Usage, or the predictive and probing controllers' load, since the last change
+    const UsageWindow& window() const { return m_window; }
+
+private:
+    // Where the cost table puts the middle of the band for this reading, or the current level without one
+    int calibrated_target(int usage) const;
+    // Where the learned cost curve puts the middle of the band
+    int predicted_target() const;
+    void observe(const Sample& sample);
+    // Whether the targeted percentile of frame time misses the refresh
+    bool tail_over_budget() const;
+    // Whether missedframes refreshes were missed since the last change, within MISSED_WINDOW
+    bool missing_refreshes() const;
+    // GPU time per frame reaches the top of the band against the refresh interval
+    bool gpu_late() const;
+    // Capped, or so shortly after a cap that readings still describe it
+    bool held() const;
+    // The level whose GPU time would put uncapped frames in the middle of the band
+    int uncapped_ceiling() const;
+
+    bool damped() const;
+    int damping() const;
+    // The highest screen percentage an increase may go to, lower than the maximum while a cycle is pinned
+    int highest() const;
+    bool window_agrees(int window_ms, bool under, int bound) const;
+    void step(int usage, Decision& decision);
+    void probe(int usage, Decision& decision);
+    void cascade(float delta, int usage, Decision& decision);
+    // False once the band is re-acquired or it has taken too long, the policy takes over again then
+    bool reacquire(Decision& decision);
+    void change(Action action, int screen_percentage, Decision& decision);
+
+    Settings m_settings;
+    Policy m_policy;
+    CostTable m_cost_table{};
+    int m_screen_percentage;
+    float m_since_increase{ 0.0f };
+    float m_since_decrease{ 0.0f };
+    float m_since_change{ 0.0f };
+    int m_frames_under_budget{ 0 };
+    int m_frames_over_budget{ 0 };
+    HitchFilter m_hitch_filter{};
+    VsyncDetector m_vsync{};
+    float m_since_on_time{ 0.0f }; // since a frame last made the refresh
+    FrameCapDetector m_frame_cap{};
+    bool m_capped{ false };
+    float m_since_cap{ 1000.0f };
+    int m_held_level{ 0 }; // where the resolution was when the cap started
+    UsageWindow m_window;
+    RollingQuantile m_frame_p95;
+    RollingQuantile m_frame_p99;
+    FrameBudget m_budget{};
+    ChangeDetector m_change_detector{};
+    bool m_reacquiring{ false };
+    float m_since_scene_change{ 0.0f };
+    OscillationDetector m_oscillation{};
+
+    // predictive and probing controllers
+    CostModel m_cost_model{};
+    int m_probe_from{ -1 };     // level before the running probe, -1 when none is running
+    int m_committed_from{ -1 }; // level before the last probe that was kept
+    int m_probe_successes{ 0 };
+    float m_probe_interval{ 1.0f };
+    float m_since_probe{ 0.0f };
+
+    // cascade
+    double m_baseline{ 0.0 };     // the outer loop's level, the inner loop's trim goes on top
+    int m_trim{ 0 };              // zero or negative
+    int m_cascade_applied{ -1 };  // what the cascade last set, anything else means it has to resync
+    int m_applied_trim{ 0 };
+    int m_missed_in_a_row{ 0 };
+    float m_since_trim{ 0.0f };
+};
+}
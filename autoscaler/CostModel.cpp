@@ -0,0 +1,61 @@
+#include "CostModel.hpp"
+
+namespace autoscaler {
+CostModel::CostModel(double scene_drift, double noise)
+    : m_scene_drift{ scene_drift },
+    m_noise{ noise }
+{
+}
+
+void CostModel::reset() {
+    *this = CostModel{ m_scene_drift, m_noise };
+}
+
+void CostModel::add(double pixels, double gpu_ms) {
+    if (pixels <= 0.0 || gpu_ms <= 0.0) {
+        return;
+    }
+
+    if (m_samples == 0) {
+        // Until resolution changes show otherwise, assume most of the cost scales with pixels
+        m_theta[0] = 0.1 * gpu_ms;
+        m_theta[1] = 0.9 * gpu_ms / pixels;
+
+        const auto spread = 0.5 * gpu_ms;
+        m_p[0][0] = spread * spread;
+        m_p[1][1] = spread * spread / (pixels * pixels);
+        m_p[0][1] = m_p[1][0] = 0.0;
+        m_samples = 1;
+        return;
+    }
+
+    // The scene scaling the curve only adds uncertainty along the current estimate, which leaves
+    // the ratio of fixed to per-pixel cost alone
+    const auto drift = m_scene_drift * m_scene_drift;
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            m_p[i][j] += drift * m_theta[i] * m_theta[j];
+        }
+    }
+
+    const double x[2]{ 1.0, pixels };
+    const double px[2]{ m_p[0][0] * x[0] + m_p[0][1] * x[1], m_p[1][0] * x[0] + m_p[1][1] * x[1] };
+
+    const auto variance = m_noise * m_noise * gpu_ms * gpu_ms;
+    const auto denominator = variance + x[0] * px[0] + x[1] * px[1];
+    const double gain[2]{ px[0] / denominator, px[1] / denominator };
+
+    const auto error = gpu_ms - predict(pixels);
+    m_theta[0] += gain[0] * error;
+    m_theta[1] += gain[1] * error;
+
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            m_p[i][j] -= gain[i] * px[j];
+        }
+    }
+
+    ++m_samples;
+}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+namespace autoscaler {
+// Online fit of GPU ms per frame = fixed + per_pixel * pixels, where pixels is relative to 100% screen
+// percentage. A recursive least squares (Kalman) update that expects the scene to scale the whole curve
+// up and down over time, so holding one resolution while the scene changes tracks the level of the curve
+// without forgetting its shape. Only changes of resolution teach it the shape.
+class CostModel {
+public:
+    // scene_drift is how much the scene is expected to scale the cost per sample, noise how far a
+    // single sample strays from the curve, both relative to the cost
+    CostModel(double scene_drift = 0.01, double noise = 0.05);
+
+    void add(double pixels, double gpu_ms);
+    void reset();
+
+    bool empty() const { return m_samples == 0; }
+    int samples() const { return m_samples; }
+    double fixed() const { return m_theta[0]; }
+    double per_pixel() const { return m_theta[1]; }
+    double predict(double pixels) const { return m_theta[0] + m_theta[1] * pixels; }
+
+private:
+    double m_scene_drift;
+    double m_noise;
+    double m_theta[2]{};
+    double m_p[2][2]{};
+    int m_samples{ 0 };
+};
+}
@@ -0,0 +1,39 @@
+#include "FrameBudget.hpp"
+
+namespace autoscaler {
+void FrameBudget::add(float delta, int usage) {
+    const auto frame_ms = delta * 1000.0;
+
+    if (frame_ms <= 0.0) {
+        return;
+    }
+
+    m_frame_ms = m_frame_ms > 0.0 ? m_frame_ms + 0.1 * (frame_ms - m_frame_ms) : frame_ms;
+
+    // The budget follows frames that made the refresh. If none have for a while the rate itself changed.
+    if (m_interval_ms <= 0.0 || frame_ms < 1.5 * m_interval_ms) {
+        m_interval_ms = m_interval_ms > 0.0 ? m_interval_ms + 0.05 * (frame_ms - m_interval_ms) : frame_ms;
+        m_slow_seconds = 0.0f;
+    }
+    else if ((m_slow_seconds += delta) > 2.0f) {
+        m_interval_ms = frame_ms;
+        m_slow_seconds = 0.0f;
+    }
+
+    if (usage == -1) {
+        return;
+    }
+
+    // Smoothed so a single noisy reading can't trigger a change
+    const auto cost_ms = usage / 100.0 * m_frame_ms;
+    m_cost_ms = m_cost_ms > 0.0 ? m_cost_ms + 0.1 * (cost_ms - m_cost_ms) : cost_ms;
+}
+
+int FrameBudget::load() const {
+    if (empty()) {
+        return -1;
+    }
+
+    return static_cast<int>(m_cost_ms / m_interval_ms * 100.0 + 0.5);
+}
+}
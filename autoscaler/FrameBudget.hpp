@@ -0,0 +1,24 @@
+#pragma once
+
+namespace autoscaler {
+// Turns NVML usage and engine deltas into GPU time per frame against the frame budget. Once frames miss
+// the refresh, usage drops because each frame now has two intervals, while GPU time keeps rising.
+class FrameBudget {
+public:
+    void add(float delta, int usage);
+
+    bool empty() const { return m_cost_ms <= 0.0 || m_interval_ms <= 0.0; }
+    double frame_ms() const { return m_frame_ms; }       // smoothed engine delta
+    double interval_ms() const { return m_interval_ms; } // the budget, deltas of missed frames are left out
+    double cost_ms() const { return m_cost_ms; }         // GPU busy time per frame, smoothed over about one NVML period
+
+    // GPU time as a percentage of the budget, -1 before the first reading
+    int load() const;
+
+private:
+    double m_frame_ms{ 0.0 };
+    double m_interval_ms{ 0.0 };
+    float m_slow_seconds{ 0.0f };
+    double m_cost_ms{ 0.0 };
+};
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <cmath>
+
+#include "FrameCap.hpp"
+
+namespace autoscaler {
+namespace {
+// Frame times are judged over this long
+constexpr float CAP_WINDOW = 1.0f;
+// Cutscenes are commonly locked to these without any console variable saying so
+constexpr double CINEMATIC_FPS[] = { 30.0, 24.0 };
+// How close the mean frame time has to come to a cap
+constexpr double CAP_TOLERANCE = 0.05;
+// A cap under this many refresh intervals can be met by single intervals, so frames aren't held to it
+constexpr double MIN_CAP_INTERVALS = 1.25;
+// Share of time frames may make a single refresh while held, e.g. the first frames of a cutscene
+constexpr float MAX_UNCAPPED_SHARE = 0.1f;
+
+bool near_cap(double frame_ms, double cap_ms, double interval_ms) {
+    return cap_ms >= MIN_CAP_INTERVALS * interval_ms && std::abs(frame_ms - cap_ms) <= CAP_TOLERANCE * cap_ms;
+}
+}
+
+void FrameCapDetector::set_engine_caps(float max_fps, int sync_interval) {
+    m_max_fps = std::max(max_fps, 0.0f);
+    m_sync_interval = std::max(sync_interval, 0);
+}
+
+bool FrameCapDetector::add(float delta, double interval_ms) {
+    if (delta <= 0.0f) {
+        return capped();
+    }
+
+    m_frames.push(delta, delta * 1000.0f);
+
+    if (interval_ms <= 0.0) {
+        m_cap_ms = 0.0;
+        m_reported = false;
+        return false;
+    }
+
+    // Held frames almost never make a single refresh, which also ends a cap quickly once play resumes
+    auto window_cap = 0.0;
+
+    if (m_frames.seconds() >= 0.9f * CAP_WINDOW) {
+        const auto single = m_frames.share_at_or_below(static_cast<float>(MIN_CAP_INTERVALS * interval_ms), CAP_WINDOW);
+        const auto mean_ms = m_frames.seconds() * 1000.0 / m_frames.size();
+        window_cap = single <= MAX_UNCAPPED_SHARE ? matching_cap(mean_ms, interval_ms) : 0.0;
+    }
+
+    // A cap the console variables report holds from the first frame held to it, only the cinematic rates
+    // have to wait for the window
+    m_cap_ms = window_cap > 0.0 ? window_cap : reported_cap(delta * 1000.0, interval_ms);
+    m_reported = capped() && reported_cap(m_cap_ms, interval_ms) > 0.0;
+    return capped();
+}
+
+void FrameCapDetector::clear() {
+    m_frames.clear();
+    m_cap_ms = 0.0;
+    m_reported = false;
+}
+
+double FrameCapDetector::reported_cap(double frame_ms, double interval_ms) const {
+    if (m_max_fps > 0.0f && near_cap(frame_ms, 1000.0 / m_max_fps, interval_ms)) {
+        return 1000.0 / m_max_fps;
+    }
+
+    if (m_sync_interval > 1 && near_cap(frame_ms, m_sync_interval * interval_ms, interval_ms)) {
+        return m_sync_interval * interval_ms;
+    }
+
+    return 0.0;
+}
+
+double FrameCapDetector::matching_cap(double mean_ms, double interval_ms) const {
+    const auto reported = reported_cap(mean_ms, interval_ms);
+
+    if (reported > 0.0) {
+        return reported;
+    }
+
+    for (const auto fps : CINEMATIC_FPS) {
+        if (near_cap(mean_ms, 1000.0 / fps, interval_ms)) {
+            return 1000.0 / fps;
+        }
+    }
+
+    return 0.0;
+}
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "TimeWindow.hpp"
+
+namespace autoscaler {
+// Recognizes frames held back by an engine frame cap: t.MaxFPS, a vsync sync interval, or a cutscene
+// locked to a cinematic rate. While one holds, the GPU idles whatever the resolution, so its readings
+// say nothing about uncapped play.
+class FrameCapDetector {
+public:
+    // From the engine's console variables, 0 for either when it doesn't cap anything
+    void set_engine_caps(float max_fps, int sync_interval);
+
+    // interval_ms is the uncapped refresh interval, 0 while it isn't known. Returns whether frames are
+    // being held to a cap.
+    bool add(float delta, double interval_ms);
+
+    void clear();
+
+    bool capped() const { return m_cap_ms > 0.0; }
+    // The capped frame time, 0 when uncapped
+    double cap_ms() const { return m_cap_ms; }
+    // Whether the cap is one the console variables report, rather than a cinematic rate read off frame times
+    bool reported() const { return m_reported; }
+
+private:
+    // The console variable cap frame_ms sits at, 0 if none does
+    double reported_cap(double frame_ms, double interval_ms) const;
+    // The cap the recent mean frame time sits at, 0 if none does
+    double matching_cap(double mean_ms, double interval_ms) const;
+
+    float m_max_fps{ 0.0f };
+    int m_sync_interval{ 0 };
+    TimeWindow<256> m_frames{ 1.0f };
+    double m_cap_ms{ 0.0 };
+    bool m_reported{ false };
+};
+}
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <cmath>
+
+#include "FramePacing.hpp"
+
+namespace autoscaler {
+namespace {
+// Longer stalls all land in the last bucket, and the ring stores the count in a byte
+constexpr int MAX_INTERVALS = 255;
+}
+
+int refresh_intervals(float delta, double interval_ms) {
+    if (interval_ms <= 0.0) {
+        return 1;
+    }
+
+    return std::clamp(static_cast<int>(std::lround(delta * 1000.0 / interval_ms)), 1, MAX_INTERVALS);
+}
+
+void PacingAnalyzer::Totals::add(double frame_ms, int frame_intervals) {
+    ++frames;
+    sum_ms += frame_ms;
+    sum_squares += frame_ms * frame_ms;
+    ++intervals[std::min(frame_intervals, 3) - 1];
+    longest_ms = std::max(longest_ms, frame_ms);
+
+    if (last_intervals != 0 && frame_intervals != last_intervals) {
+        ++cadence_changes;
+    }
+
+    last_intervals = frame_intervals;
+}
+
+PacingStats PacingAnalyzer::Totals::stats() const {
+    PacingStats stats{};
+    stats.frames = frames;
+    stats.intervals = intervals;
+    stats.longest_ms = longest_ms;
+
+    if (frames == 0) {
+        return stats;
+    }
+
+    stats.mean_ms = sum_ms / frames;
+    stats.stddev_ms = std::sqrt(std::max(sum_squares / frames - stats.mean_ms * stats.mean_ms, 0.0));
+    stats.judder = frames > 1 ? 100.0 * cadence_changes / (frames - 1) : 0.0;
+    return stats;
+}
+
+void PacingAnalyzer::add(float delta, int intervals) {
+    const auto frame_ms = delta * 1000.0;
+
+    if (frame_ms <= 0.0) {
+        return;
+    }
+
+    intervals = std::clamp(intervals, 1, MAX_INTERVALS);
+    m_session.add(frame_ms, intervals);
+
+    m_frame_ms[m_head] = static_cast<float>(frame_ms);
+    m_intervals[m_head] = static_cast<std::uint8_t>(intervals);
+    m_head = (m_head + 1) % HISTORY;
+    m_count = std::min(m_count + 1, HISTORY);
+}
+
+void PacingAnalyzer::clear() {
+    m_session = {};
+    m_frame_ms.fill(0.0f);
+    m_intervals.fill(0);
+    m_head = 0;
+    m_count = 0;
+}
+
+PacingStats PacingAnalyzer::session() const {
+    return m_session.stats();
+}
+
+PacingStats PacingAnalyzer::recent() const {
+    Totals totals{};
+    const auto oldest = (m_head + HISTORY - m_count) % HISTORY;
+
+    for (size_t i = 0; i < m_count; ++i) {
+        const auto at = (oldest + i) % HISTORY;
+        totals.add(m_frame_ms[at], m_intervals[at]);
+    }
+
+    return totals.stats();
+}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace autoscaler {
+// How evenly frames were delivered
+struct PacingStats {
+    int frames{ 0 };
+    double mean_ms{ 0.0 };
+    double stddev_ms{ 0.0 };
+    std::array<int, 3> intervals{}; // frames that took one, two, and three or more refresh intervals
+    double longest_ms{ 0.0 };       // the longest stall
+    // Percent of frames whose cadence differs from the one before. A steady 1-2-1-2 alternation, which
+    // judders, scores 100, even though its average looks like a steady rate of one and a half intervals.
+    double judder{ 0.0 };
+};
+
+// Refresh intervals a frame of delta seconds took, deltas jitter around whole multiples of the interval.
+// 1 while interval_ms isn't known.
+int refresh_intervals(float delta, double interval_ms);
+
+// Frame delivery over the whole session and over the last HISTORY frames. The session keeps running sums,
+// the recent frames a ring that doubles as the data for a graph. Never allocates.
+class PacingAnalyzer {
+public:
+    static constexpr size_t HISTORY = 256;
+
+    void add(float delta, int intervals);
+
+    void clear();
+
+    PacingStats session() const;
+    PacingStats recent() const;
+
+    // Frame times of the last HISTORY frames in milliseconds, oldest at history_offset(), the way
+    // ImGui::PlotLines takes a ring
+    const std::array<float, HISTORY>& history() const { return m_frame_ms; }
+    size_t history_offset() const { return m_head; }
+
+private:
+    struct Totals {
+        int frames{ 0 };
+        double sum_ms{ 0.0 };
+        double sum_squares{ 0.0 };
+        std::array<int, 3> intervals{};
+        double longest_ms{ 0.0 };
+        int cadence_changes{ 0 };
+        int last_intervals{ 0 };
+
+        void add(double frame_ms, int frame_intervals);
+        PacingStats stats() const;
+    };
+
+    Totals m_session{};
+    std::array<float, HISTORY> m_frame_ms{};
+    std::array<std::uint8_t, HISTORY> m_intervals{};
+    size_t m_head{ 0 };
+    size_t m_count{ 0 };
+};
+}
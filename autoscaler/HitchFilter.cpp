@@ -0,0 +1,71 @@
+#include "HitchFilter.hpp"
+
+namespace autoscaler {
+namespace {
+// A missed refresh doubles the frame time and is real overload, a hitch takes several intervals
+constexpr float HITCH_FACTOR = 2.5f;
+// Longer runs of slow frames are the game slowing down, not a hitch
+constexpr int MAX_HITCH_FRAMES = 3;
+// Percentage points over the median reading that count as a spike
+constexpr float HITCH_USAGE_JUMP = 20.0f;
+// About one NVML sampling period, a spike that outlasts it is in more than one reading
+constexpr float HITCH_USAGE_SECONDS = 0.25f;
+// Usage rising this soon after a change follows from the change
+constexpr float CHANGE_SECONDS = 1.0f;
+// Medians need some history before anything is judged against them
+constexpr float MIN_HISTORY_SECONDS = 0.25f;
+}
+
+void HitchFilter::clear() {
+    m_deltas.clear();
+    m_usages.clear();
+    m_hitch_frames = 0;
+    m_held_seconds = 0.0f;
+}
+
+HitchFilter::Result HitchFilter::filter(float delta, int usage, float since_change) {
+    Result result{ delta, usage, Hitch::None };
+
+    if (m_deltas.seconds() >= MIN_HISTORY_SECONDS) {
+        const auto median = m_deltas.median(1.0f);
+
+        if (delta > HITCH_FACTOR * median && m_hitch_frames < MAX_HITCH_FRAMES) {
+            ++m_hitch_frames;
+            result.delta = median;
+            result.hitch = Hitch::Frame;
+        }
+        else if (delta <= HITCH_FACTOR * median) {
+            m_hitch_frames = 0;
+        }
+    }
+
+    // Hitches stay out of the median so a burst of them can't raise the bar for the next
+    if (result.hitch == Hitch::None) {
+        m_deltas.push(delta, delta);
+    }
+
+    if (usage == -1) {
+        return result;
+    }
+
+    const auto jumped = m_usages.seconds() >= MIN_HISTORY_SECONDS && usage >= m_usages.median(2.0f) + HITCH_USAGE_JUMP;
+
+    if (jumped && since_change >= CHANGE_SECONDS && m_held_seconds < HITCH_USAGE_SECONDS) {
+        m_held_seconds += result.delta;
+        result.usage = -1;
+
+        if (result.hitch == Hitch::None) {
+            result.hitch = Hitch::Usage;
+        }
+
+        return result;
+    }
+
+    if (!jumped) {
+        m_held_seconds = 0.0f;
+    }
+
+    m_usages.push(result.delta, static_cast<float>(usage));
+    return result;
+}
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "TimeWindow.hpp"
+
+namespace autoscaler {
+enum class Hitch {
+    None,
+    Frame, // engine delta far above the recent median
+    Usage, // GPU usage jumped well above the recent median without us raising the resolution
+};
+
+// Recognizes one-off spikes from shader compilation, PSO creation and streaming, which have nothing to do
+// with resolution. A spike is only held back while it stays short; one that lasts is a real change in load
+// and passes through, late by at most MAX_HITCH_FRAMES frames or HITCH_USAGE_SECONDS.
+class HitchFilter {
+public:
+    struct Result {
+        float delta{ 0.0f };  // the median frame in place of a hitch
+        int usage{ -1 };      // -1 while a usage spike is held back
+        Hitch hitch{ Hitch::None };
+    };
+
+    // since_change is the time since the controller last changed the screen percentage. Usage that
+    // rises soon after a change was caused by it and is never held back.
+    Result filter(float delta, int usage, float since_change);
+
+    void clear();
+
+private:
+    TimeWindow<256> m_deltas{ 1.0f };
+    TimeWindow<256> m_usages{ 2.0f };
+    int m_hitch_frames{ 0 };
+    float m_held_seconds{ 0.0f };
+};
+}
@@ -0,0 +1,91 @@
+#include <algorithm>
+
+#include "Oscillation.hpp"
+
+namespace autoscaler {
+namespace {
+// Reversals this close together are a cycle rather than the controller following the scene
+constexpr float CYCLE_WINDOW = 20.0f;
+constexpr size_t REVERSALS_PER_DETECTION = 3;
+// Without a reversal for this long the damping steps back down a level
+constexpr float QUIET_SECONDS = 30.0f;
+constexpr int MAX_LEVEL = 3;
+// From this level on increases are pinned to the lowest value of the cycle
+constexpr int PIN_LEVEL = 2;
+}
+
+void OscillationDetector::clear() {
+    m_level = 0;
+    m_ceiling = -1;
+    m_quiet = 0.0f;
+    m_has_last = false;
+    m_reversal_count = 0;
+    m_change_count = 0;
+}
+
+void OscillationDetector::tick(float seconds) {
+    m_time += seconds;
+    m_quiet += seconds;
+
+    if (m_level > 0 && m_quiet >= QUIET_SECONDS) {
+        --m_level;
+        m_quiet = 0.0f;
+
+        if (m_level < PIN_LEVEL) {
+            m_ceiling = -1;
+        }
+    }
+}
+
+bool OscillationDetector::record(bool up, int from, int to) {
+    // Oldest first, the arrays are tiny so shifting is cheap
+    if (m_change_count == m_changes.size()) {
+        std::copy(m_changes.begin() + 1, m_changes.end(), m_changes.begin());
+        --m_change_count;
+    }
+
+    m_changes[m_change_count++] = { m_time, std::min(from, to) };
+
+    const auto reversed = m_has_last && up != m_last_up;
+    m_last_up = up;
+    m_has_last = true;
+
+    if (!reversed) {
+        return false;
+    }
+
+    ++m_reversals;
+    m_quiet = 0.0f;
+
+    if (m_reversal_count == m_reversal_times.size()) {
+        std::copy(m_reversal_times.begin() + 1, m_reversal_times.end(), m_reversal_times.begin());
+        --m_reversal_count;
+    }
+
+    m_reversal_times[m_reversal_count++] = m_time;
+
+    const auto recent = std::count_if(m_reversal_times.begin(), m_reversal_times.begin() + m_reversal_count,
+        [this](float time) { return m_time - time <= CYCLE_WINDOW; });
+
+    if (static_cast<size_t>(recent) < REVERSALS_PER_DETECTION) {
+        return false;
+    }
+
+    m_level = std::min(m_level + 1, MAX_LEVEL);
+    m_reversal_count = 0;
+
+    if (m_level >= PIN_LEVEL) {
+        auto low = -1;
+
+        for (size_t i = 0; i < m_change_count; ++i) {
+            if (m_time - m_changes[i].time <= CYCLE_WINDOW && (low < 0 || m_changes[i].low < low)) {
+                low = m_changes[i].low;
+            }
+        }
+
+        m_ceiling = low;
+    }
+
+    return true;
+}
+}
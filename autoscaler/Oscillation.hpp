@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace autoscaler {
+// Spots the screen percentage cycling up and down between a few values, which costs an upscaler history
+// reset and maybe a render target reallocation on every change. Each time enough reversals pile up
+// within CYCLE_WINDOW the damping level goes up, and it comes down one level per quiet period.
+class OscillationDetector {
+public:
+    void tick(float seconds);
+
+    // Returns true when this change raised the damping level
+    bool record(bool up, int from, int to);
+
+    // Back to no damping, e.g. after a scene change makes the old cycle meaningless
+    void clear();
+
+    // 0 is undamped
+    int level() const { return m_level; }
+    // Full up and down cycles seen since the start
+    int cycles() const { return m_reversals / 2; }
+    // Increases stop here while pinned, -1 otherwise
+    int ceiling() const { return m_ceiling; }
+
+private:
+    struct Change {
+        float time;
+        int low; // the lower end of the change
+    };
+
+    float m_time{ 0.0f };
+    float m_quiet{ 0.0f };
+    int m_level{ 0 };
+    int m_ceiling{ -1 };
+    int m_reversals{ 0 };
+    bool m_last_up{ false };
+    bool m_has_last{ false };
+
+    std::array<float, 4> m_reversal_times{};
+    size_t m_reversal_count{ 0 };
+    std::array<Change, 8> m_changes{};
+    size_t m_change_count{ 0 };
+};
+}
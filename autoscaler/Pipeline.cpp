@@ -0,0 +1,25 @@
+#include "Pipeline.hpp"
+
+namespace autoscaler {
+Pipeline::Pipeline(Sensor& sensor, Controller& controller, Actuator& actuator)
+    : m_sensor{ sensor },
+    m_controller{ controller },
+    m_actuator{ actuator }
+{
+}
+
+Decision Pipeline::tick(float delta) {
+    Sample sample{};
+    sample.delta = delta;
+    sample.usage = m_sensor.read_usage();
+
+    const auto decision = m_controller.update(sample);
+
+    // Without a reading, missed refreshes can still change it
+    if (sample.usage != -1 || decision.action != Action::None) {
+        m_actuator.apply(decision.screen_percentage);
+    }
+
+    return decision;
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Controller.hpp"
+
+namespace autoscaler {
+// Where GPU usage comes from. The plugin reads NVML, tests and tools feed recorded or simulated values.
+class Sensor {
+public:
+    virtual ~Sensor() = default;
+
+    // GPU usage in percent, or -1 if no reading is available
+    virtual int read_usage() = 0;
+};
+
+// Where the chosen screen percentage goes. The plugin sets r.ScreenPercentage.
+class Actuator {
+public:
+    virtual ~Actuator() = default;
+
+    virtual void apply(int screen_percentage) = 0;
+};
+
+// sensor -> controller -> actuator, run once per engine tick
+class Pipeline {
+public:
+    Pipeline(Sensor& sensor, Controller& controller, Actuator& actuator);
+
+    // The actuator is driven when the sensor produced a reading or the controller made a change
+    Decision tick(float delta);
+
+private:
+    Sensor& m_sensor;
+    Controller& m_controller;
+    Actuator& m_actuator;
+};
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "Quantile.hpp"
+
+namespace autoscaler {
+P2Quantile::P2Quantile(double quantile)
+    : m_quantile{ std::clamp(quantile, 0.0, 1.0) }
+{
+    m_increments = { 0.0, m_quantile / 2.0, m_quantile, (1.0 + m_quantile) / 2.0, 1.0 };
+}
+
+void P2Quantile::clear() {
+    m_count = 0;
+}
+
+double P2Quantile::value() const {
+    if (m_count == 0) {
+        return 0.0;
+    }
+
+    if (m_count < 5) {
+        // Not enough for the markers yet, the first values are kept sorted instead
+        const auto rank = static_cast<size_t>(m_quantile * (m_count - 1) + 0.5);
+        return m_heights[rank];
+    }
+
+    return m_heights[2];
+}
+
+void P2Quantile::add(double value) {
+    if (m_count < 5) {
+        const auto end = m_heights.begin() + m_count;
+        const auto at = std::upper_bound(m_heights.begin(), end, value);
+        std::copy_backward(at, end, end + 1);
+        *at = value;
+
+        if (++m_count == 5) {
+            m_positions = { 0.0, 1.0, 2.0, 3.0, 4.0 };
+            m_desired = { 0.0, 2.0 * m_quantile, 4.0 * m_quantile, 2.0 + 2.0 * m_quantile, 4.0 };
+        }
+
+        return;
+    }
+
+    // The cell the value falls in, stretching the ends when it's a new extreme
+    int cell = 0;
+
+    if (value < m_heights[0]) {
+        m_heights[0] = value;
+    }
+    else if (value >= m_heights[4]) {
+        m_heights[4] = value;
+        cell = 3;
+    }
+    else {
+        while (cell < 3 && value >= m_heights[cell + 1]) {
+            ++cell;
+        }
+    }
+
+    ++m_count;
+
+    for (int i = cell + 1; i < 5; ++i) {
+        m_positions[i] += 1.0;
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        m_desired[i] += m_increments[i];
+    }
+
+    // Move the middle markers at most one position towards where they should be
+    for (int i = 1; i < 4; ++i) {
+        const auto off = m_desired[i] - m_positions[i];
+
+        if ((off >= 1.0 && m_positions[i + 1] - m_positions[i] > 1.0) || (off <= -1.0 && m_positions[i - 1] - m_positions[i] < -1.0)) {
+            const auto d = off > 0.0 ? 1 : -1;
+            const auto height = parabolic(i, d);
+
+            // The parabola can overshoot a neighbour, fall back to a straight line then
+            m_heights[i] = m_heights[i - 1] < height && height < m_heights[i + 1] ? height : linear(i, d);
+            m_positions[i] += d;
+        }
+    }
+}
+
+double P2Quantile::parabolic(int i, int d) const {
+    const auto& q = m_heights;
+    const auto& n = m_positions;
+    return q[i] + d / (n[i + 1] - n[i - 1])
+        * ((n[i] - n[i - 1] + d) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) + (n[i + 1] - n[i] - d) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+}
+
+double P2Quantile::linear(int i, int d) const {
+    return m_heights[i] + d * (m_heights[i + d] - m_heights[i]) / (m_positions[i + d] - m_positions[i]);
+}
+
+RollingQuantile::RollingQuantile(double quantile, float span)
+    : m_span{ span },
+    m_estimators{ P2Quantile{ quantile }, P2Quantile{ quantile } }
+{
+    clear();
+}
+
+void RollingQuantile::set_span(float span) {
+    m_span = span;
+}
+
+void RollingQuantile::clear() {
+    m_estimators[0].clear();
+    m_estimators[1].clear();
+    m_ages = { 0.0f, -m_span / 2.0f };
+}
+
+void RollingQuantile::push(float seconds, double value) {
+    for (size_t i = 0; i < m_estimators.size(); ++i) {
+        if (m_ages[i] >= 0.0f) {
+            m_estimators[i].add(value);
+        }
+
+        m_ages[i] += seconds;
+
+        if (m_ages[i] >= m_span) {
+            m_estimators[i].clear();
+            m_ages[i] = 0.0f;
+        }
+    }
+}
+}
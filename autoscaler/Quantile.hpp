@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+namespace autoscaler {
+// Streaming estimate of one quantile in constant memory, Jain and Chlamtac's P² algorithm. Five markers
+// follow the minimum, the quantile, the maximum and the points halfway between, and are moved along a
+// parabola fitted through their neighbours as values arrive.
+class P2Quantile {
+public:
+    explicit P2Quantile(double quantile = 0.5);
+
+    void add(double value);
+    void clear();
+
+    size_t count() const { return m_count; }
+    // Exact over the first five values, 0 before any
+    double value() const;
+
+private:
+    double parabolic(int i, int d) const;
+    double linear(int i, int d) const;
+
+    double m_quantile;
+    size_t m_count{ 0 };
+    std::array<double, 5> m_heights{};   // marker values
+    std::array<double, 5> m_positions{}; // marker positions, whole numbers
+    std::array<double, 5> m_desired{};   // where the markers should be
+    std::array<double, 5> m_increments{};
+};
+
+// A quantile of roughly the last span seconds. Two estimators run staggered by half a span and each starts
+// over once it has covered a whole one; the older of the two answers, so the result always covers between
+// half a span and a span of the newest values.
+class RollingQuantile {
+public:
+    RollingQuantile(double quantile, float span);
+
+    void set_span(float span);
+    void push(float seconds, double value);
+    void clear();
+
+    // Values behind the current estimate
+    size_t count() const { return current().count(); }
+    double value() const { return current().value(); }
+
+private:
+    const P2Quantile& current() const { return m_ages[0] >= m_ages[1] ? m_estimators[0] : m_estimators[1]; }
+
+    float m_span;
+    std::array<P2Quantile, 2> m_estimators;
+    std::array<float, 2> m_ages{}; // negative until that estimator starts
+};
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace autoscaler {
+// splitmix64 with Box-Muller on top. The standard distributions differ between standard
+// libraries, this gives the same numbers for a seed on every platform.
+class Random {
+public:
+    explicit Random(std::uint64_t seed) : m_state{ seed } {}
+
+    std::uint64_t next() {
+        auto z = (m_state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // (0, 1), never exactly 0 so it is safe to take the log of
+    double uniform() { return ((next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+
+    // [0, n)
+    std::uint64_t below(std::uint64_t n) { return next() % n; }
+
+    double gaussian() {
+        if (m_has_spare) {
+            m_has_spare = false;
+            return m_spare;
+        }
+
+        const auto u1 = uniform();
+        const auto u2 = uniform();
+        const auto r = std::sqrt(-2.0 * std::log(u1));
+        const auto theta = 6.283185307179586 * u2;
+
+        m_spare = r * std::sin(theta);
+        m_has_spare = true;
+        return r * std::cos(theta);
+    }
+
+private:
+    std::uint64_t m_state;
+    bool m_has_spare{ false };
+    double m_spare{ 0.0 };
+};
+}
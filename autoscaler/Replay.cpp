@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "Replay.hpp"
+
+namespace autoscaler {
+SessionStatsBuilder::SessionStatsBuilder(int lower_bound, int upper_bound)
+    : m_lower_bound{ lower_bound },
+    m_upper_bound{ upper_bound }
+{
+}
+
+void SessionStatsBuilder::add(double delta, int usage, int screen_percentage, Action action, int missed_frames) {
+    ++m_stats.frames;
+    m_stats.seconds += delta;
+    m_stats.missed_frames += missed_frames;
+    m_stats.changes += action != Action::None ? 1 : 0;
+    m_pacing.add(static_cast<float>(delta), missed_frames + 1);
+
+    if (usage > m_lower_bound && usage < m_upper_bound) {
+        m_in_band_seconds += delta;
+    }
+
+    m_screen_percentage_sum += screen_percentage * delta;
+
+    const auto bucket = std::clamp(screen_percentage, 0, static_cast<int>(m_screen_percentage_time.size()) - 1);
+    m_screen_percentage_time[bucket] += delta;
+}
+
+SessionStats SessionStatsBuilder::finish() const {
+    auto stats = m_stats;
+    stats.pacing = m_pacing.session();
+
+    if (stats.seconds <= 0.0) {
+        return stats;
+    }
+
+    stats.time_in_band = m_in_band_seconds / stats.seconds;
+    stats.mean_screen_percentage = m_screen_percentage_sum / stats.seconds;
+
+    double seen = 0.0;
+    for (size_t i = 0; i < m_screen_percentage_time.size(); ++i) {
+        seen += m_screen_percentage_time[i];
+
+        if (seen >= stats.seconds * 0.05) {
+            stats.p5_screen_percentage = static_cast<double>(i);
+            break;
+        }
+    }
+
+    return stats;
+}
+
+double estimate_refresh_interval(const std::uint8_t* data, size_t size) {
+    // 0.1ms buckets up to 100ms, enough to tell 144Hz from 120Hz
+    std::vector<int> counts(1000, 0);
+    std::vector<std::int64_t> sums(1000, 0);
+
+    TraceDecoder decoder{ data, size };
+    TraceRecord record{};
+
+    while (decoder.next(record)) {
+        const auto bucket = record.delta_us / 100;
+
+        if (bucket > 0 && bucket < static_cast<std::int64_t>(counts.size())) {
+            ++counts[static_cast<size_t>(bucket)];
+            sums[static_cast<size_t>(bucket)] += record.delta_us;
+        }
+    }
+
+    const auto mode = static_cast<size_t>(std::max_element(counts.begin(), counts.end()) - counts.begin());
+    if (counts[mode] == 0) {
+        return 0.0;
+    }
+
+    // the mean of the deltas that landed in the busiest bucket
+    return static_cast<double>(sums[mode]) / counts[mode] / 1'000'000.0;
+}
+
+ReplayResult replay_trace(const std::uint8_t* data, size_t size, const Settings& settings, const Settings& recorded_settings,
+    const std::function<void(const ReplayTick&)>& on_tick)
+{
+    ReplayResult result{};
+    result.refresh_interval = estimate_refresh_interval(data, size);
+
+    TraceDecoder decoder{ data, size };
+    if (!decoder.valid() || result.refresh_interval <= 0.0) {
+        return result;
+    }
+
+    const auto refresh = result.refresh_interval;
+
+    // measured deltas jitter around the interval, so round them
+    const auto recorded_intervals = [refresh](double delta) {
+        return std::max(1, static_cast<int>(std::lround(delta / refresh)));
+    };
+
+    // a frame that needs any more GPU time than one interval waits for the next
+    const auto needed_intervals = [refresh](double gpu_seconds) {
+        return std::max(1, static_cast<int>(std::ceil(gpu_seconds / refresh - 1e-9)));
+    };
+
+    SessionStatsBuilder recorded{ recorded_settings.usagelowerbound, recorded_settings.usageupperbound };
+    SessionStatsBuilder replayed{ recorded_settings.usagelowerbound, recorded_settings.usageupperbound };
+
+    TraceRecord record{};
+    bool started = false;
+    int rendered_at = 0;
+    double time = 0.0;
+    Controller controller{ settings };
+
+    while (decoder.next(record)) {
+        const auto delta = record.delta_us / 1'000'000.0;
+
+        if (!started) {
+            // start from wherever the recorded session started
+            controller = Controller{ settings, record.screen_percentage };
+            rendered_at = record.screen_percentage;
+            started = true;
+        }
+
+        // Each record holds the percentage chosen after the tick, the tick's frame was
+        // rendered at the one chosen before it
+        recorded.add(delta, record.usage, rendered_at, record.action, recorded_intervals(delta) - 1);
+
+        Sample sample{};
+        sample.delta = static_cast<float>(delta);
+        sample.usage = record.usage;
+
+        auto missed = recorded_intervals(delta) - 1;
+        const auto screen_percentage = controller.screen_percentage();
+
+        if (record.usage >= 0 && rendered_at > 0) {
+            const auto scale = static_cast<double>(screen_percentage) / rendered_at;
+            const auto gpu_seconds = record.usage / 100.0 * delta * scale * scale;
+            const auto intervals = needed_intervals(gpu_seconds);
+
+            sample.delta = static_cast<float>(intervals * refresh);
+            sample.usage = static_cast<int>(std::lround(std::min(gpu_seconds / (intervals * refresh), 1.0) * 100.0));
+            missed = intervals - 1;
+        }
+
+        const auto decision = controller.update(sample);
+        replayed.add(sample.delta, sample.usage, screen_percentage, decision.action, missed);
+
+        if (on_tick) {
+            on_tick({ time, sample.delta, sample.usage, screen_percentage, missed, decision });
+        }
+
+        time += sample.delta;
+
+        rendered_at = record.screen_percentage;
+    }
+
+    result.recorded = recorded.finish();
+    result.replayed = replayed.finish();
+    return result;
+}
+}
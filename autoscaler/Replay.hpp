@@ -0,0 +1,73 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <functional>
+
+#include "FramePacing.hpp"
+#include "Trace.hpp"
+
+namespace autoscaler {
+struct SessionStats {
+    double seconds{ 0.0 };
+    int frames{ 0 };
+    double time_in_band{ 0.0 };          // fraction of time usage sat strictly inside the band
+    int missed_frames{ 0 };              // refresh intervals that didn't get a new frame
+    double mean_screen_percentage{ 0.0 };
+    double p5_screen_percentage{ 0.0 };  // 5% of the time resolution was at or below this
+    int changes{ 0 };
+    PacingStats pacing{};
+};
+
+// Accumulates SessionStats one tick at a time, in constant memory
+class SessionStatsBuilder {
+public:
+    SessionStatsBuilder(int lower_bound, int upper_bound);
+
+    void add(double delta, int usage, int screen_percentage, Action action, int missed_frames);
+    SessionStats finish() const;
+
+private:
+    int m_lower_bound;
+    int m_upper_bound;
+    SessionStats m_stats{};
+    double m_in_band_seconds{ 0.0 };
+    double m_screen_percentage_sum{ 0.0 };
+    std::array<double, 1001> m_screen_percentage_time{}; // seconds spent at each whole screen percentage
+    PacingAnalyzer m_pacing{};
+};
+
+// The refresh interval the session ran at, taken as the most common engine delta.
+// Returns 0 if the trace has no usable deltas.
+double estimate_refresh_interval(const std::uint8_t* data, size_t size);
+
+// One replayed tick, as the given settings would have played it
+struct ReplayTick {
+    double time{ 0.0 };
+    double delta{ 0.0 };
+    int usage{ -1 };
+    int screen_percentage{ 0 }; // what the frame was rendered at
+    int missed_frames{ 0 };
+    Decision decision{};
+};
+
+struct ReplayResult {
+    double refresh_interval{ 0.0 };
+    SessionStats recorded{}; // what the plugin actually did
+    SessionStats replayed{}; // what the given settings would have done
+};
+
+// Runs a recorded trace through a controller with the given settings.
+//
+// Changing resolution changes the load the controller would have seen, so each tick's
+// GPU busy time (usage x delta) is rescaled by the ratio of pixel counts between the
+// replayed and recorded screen percentage. That gives the frame cost, how many refresh
+// intervals the frame would have taken and the usage the controller gets to see.
+// This ignores NVML's averaging and any resolution independent GPU cost, so it is an
+// estimate, but the same estimate for every policy.
+//
+// Time in band is scored against the band of the settings the session was recorded with,
+// for the recorded and the replayed session alike, so results for different settings compare.
+ReplayResult replay_trace(const std::uint8_t* data, size_t size, const Settings& settings, const Settings& recorded_settings,
+    const std::function<void(const ReplayTick&)>& on_tick = {});
+}
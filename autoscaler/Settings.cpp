@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <cctype>
+
+#include "Settings.hpp"
+
+namespace autoscaler {
+namespace {
+std::string to_lower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return str;
+}
+}
+
+bool apply_settings(const nlohmann::json& j, Settings& settings) {
+    if (!j.is_object()) {
+        return false;
+    }
+
+    const auto read = [&](const char* key, int& value) {
+        if (j.contains(key) && j[key].is_number()) {
+            value = j[key];
+        }
+    };
+
+    read("usagelowerbound", settings.usagelowerbound);
+    read("usageupperbound", settings.usageupperbound);
+    read("decreaseframesrequired", settings.decreaseframesrequired);
+    read("increaseframesrequired", settings.increaseframesrequired);
+    read("decreaseresamount", settings.decreaseresamount);
+    read("increaseresamount", settings.increaseresamount);
+    read("minscreenpercentage", settings.minscreenpercentage);
+    read("maxscreenpercentage", settings.maxscreenpercentage);
+    read("increasewindowms", settings.increasewindowms);
+    read("decreasewindowms", settings.decreasewindowms);
+    read("windowshare", settings.windowshare);
+    read("tailwindowms", settings.tailwindowms);
+    read("missedframes", settings.missedframes);
+    read("innerframes", settings.innerframes);
+    read("innerstep", settings.innerstep);
+    read("innermaxtrim", settings.innermaxtrim);
+    read("innerrecoveryms", settings.innerrecoveryms);
+    read("outertimems", settings.outertimems);
+
+    if (j.contains("telemetry") && j["telemetry"].is_boolean()) {
+        settings.telemetry = j["telemetry"];
+    }
+
+    if (j.contains("oscillationdamping") && j["oscillationdamping"].is_boolean()) {
+        settings.oscillationdamping = j["oscillationdamping"];
+    }
+
+    if (j.contains("changedetection") && j["changedetection"].is_boolean()) {
+        settings.changedetection = j["changedetection"];
+    }
+
+    if (j.contains("hitchfilter") && j["hitchfilter"].is_boolean()) {
+        settings.hitchfilter = j["hitchfilter"];
+    }
+
+    if (j.contains("usecalibration") && j["usecalibration"].is_boolean()) {
+        settings.usecalibration = j["usecalibration"];
+    }
+
+    if (j.contains("capdetection") && j["capdetection"].is_boolean()) {
+        settings.capdetection = j["capdetection"];
+    }
+
+    if (j.contains("raiseduringcaps") && j["raiseduringcaps"].is_boolean()) {
+        settings.raiseduringcaps = j["raiseduringcaps"];
+    }
+
+    // The same ranges the UI's sliders allow. A band narrower than 5 points or turned upside down would
+    // make the controller chase its own steps.
+    settings.usagelowerbound = std::clamp(settings.usagelowerbound, 60, 95);
+    settings.usageupperbound = std::max(std::clamp(settings.usageupperbound, 60, 95), settings.usagelowerbound + 5);
+    settings.increaseframesrequired = std::clamp(settings.increaseframesrequired, 1, 1000);
+    settings.decreaseframesrequired = std::clamp(settings.decreaseframesrequired, 1, 1000);
+    settings.increaseresamount = std::clamp(settings.increaseresamount, 1, 20);
+    settings.decreaseresamount = std::clamp(settings.decreaseresamount, 1, 20);
+    settings.minscreenpercentage = std::clamp(settings.minscreenpercentage, 10, 100);
+    settings.maxscreenpercentage = std::clamp(settings.maxscreenpercentage, settings.minscreenpercentage, 200);
+    settings.increasewindowms = std::clamp(settings.increasewindowms, 0, MAX_WINDOW_MS);
+    settings.decreasewindowms = std::clamp(settings.decreasewindowms, 0, MAX_WINDOW_MS);
+    settings.windowshare = std::clamp(settings.windowshare, 50, 100);
+    settings.tailwindowms = std::clamp(settings.tailwindowms, 500, MAX_WINDOW_MS);
+    settings.missedframes = std::clamp(settings.missedframes, 0, 60);
+    settings.innerframes = std::clamp(settings.innerframes, 1, 10);
+    settings.innerstep = std::clamp(settings.innerstep, 1, 20);
+    settings.innermaxtrim = std::clamp(settings.innermaxtrim, settings.innerstep, 50);
+    settings.innerrecoveryms = std::clamp(settings.innerrecoveryms, 100, 5000);
+    settings.outertimems = std::clamp(settings.outertimems, 100, 20000);
+
+    bool ok = true;
+
+    if (j.contains("sensor") && j["sensor"].is_string()) {
+        settings.sensor = j["sensor"];
+
+        // NVML is the only usage source so far
+        if (settings.sensor != "nvml") {
+            settings.sensor = "nvml";
+            ok = false;
+        }
+    }
+
+    if (j.contains("controller") && j["controller"].is_string()) {
+        settings.controller = j["controller"];
+
+        if (settings.controller != "step" && settings.controller != "predictive" && settings.controller != "probe"
+            && settings.controller != "cascade") {
+            settings.controller = "step";
+            ok = false;
+        }
+    }
+
+    if (j.contains("tailpercentile") && j["tailpercentile"].is_number_integer()) {
+        settings.tailpercentile = j["tailpercentile"];
+
+        if (settings.tailpercentile != 0 && settings.tailpercentile != 95 && settings.tailpercentile != 99) {
+            settings.tailpercentile = 0;
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+nlohmann::json settings_to_json(const Settings& settings) {
+    nlohmann::json j;
+    j["usagelowerbound"] = settings.usagelowerbound;
+    j["usageupperbound"] = settings.usageupperbound;
+    j["decreaseframesrequired"] = settings.decreaseframesrequired;
+    j["increaseframesrequired"] = settings.increaseframesrequired;
+    j["decreaseresamount"] = settings.decreaseresamount;
+    j["increaseresamount"] = settings.increaseresamount;
+    j["minscreenpercentage"] = settings.minscreenpercentage;
+    j["maxscreenpercentage"] = settings.maxscreenpercentage;
+    j["increasewindowms"] = settings.increasewindowms;
+    j["decreasewindowms"] = settings.decreasewindowms;
+    j["windowshare"] = settings.windowshare;
+    j["tailpercentile"] = settings.tailpercentile;
+    j["tailwindowms"] = settings.tailwindowms;
+    j["missedframes"] = settings.missedframes;
+    j["innerframes"] = settings.innerframes;
+    j["innerstep"] = settings.innerstep;
+    j["innermaxtrim"] = settings.innermaxtrim;
+    j["innerrecoveryms"] = settings.innerrecoveryms;
+    j["outertimems"] = settings.outertimems;
+    j["sensor"] = settings.sensor;
+    j["controller"] = settings.controller;
+    j["telemetry"] = settings.telemetry;
+    j["oscillationdamping"] = settings.oscillationdamping;
+    j["changedetection"] = settings.changedetection;
+    j["hitchfilter"] = settings.hitchfilter;
+    j["usecalibration"] = settings.usecalibration;
+    j["capdetection"] = settings.capdetection;
+    j["raiseduringcaps"] = settings.raiseduringcaps;
+    return j;
+}
+
+int select_profile(const nlohmann::json& store, const std::string& exe, const std::string& commit, const std::string& tag) {
+    if (!store.is_object() || !store.contains("profiles") || !store["profiles"].is_array()) {
+        return -1;
+    }
+
+    const auto& profiles = store["profiles"];
+    const auto exe_lower = to_lower(exe);
+
+    int any_build = -1;
+
+    for (int i = 0; i < static_cast<int>(profiles.size()); ++i) {
+        const auto& profile = profiles[i];
+
+        if (!profile.is_object() || !profile.contains("game") || !profile["game"].is_string()) {
+            continue;
+        }
+
+        if (to_lower(profile["game"].get<std::string>()) != exe_lower) {
+            continue;
+        }
+
+        if (!profile.contains("uevr")) {
+            if (any_build < 0) {
+                any_build = i;
+            }
+
+            continue;
+        }
+
+        const auto build = profile["uevr"].is_string() ? profile["uevr"].get<std::string>() : std::string{};
+
+        if (!build.empty() && (build == tag || commit.starts_with(build))) {
+            return i;
+        }
+    }
+
+    return any_build;
+}
+}
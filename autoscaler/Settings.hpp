@@ -0,0 +1,64 @@
+#pragma once
+
+#include <string>
+
+#include "json.hpp"
+
+namespace autoscaler {
+// Everything the user can tune, as stored in autoscalerconfig.json and the profile store
+struct Settings {
+    int usagelowerbound = 82;
+    int usageupperbound = 92;
+    int decreaseresamount = 2;
+    int increaseresamount = 1;
+    int decreaseframesrequired = 10;
+    int increaseframesrequired = 20;
+    int minscreenpercentage = 20;
+    int maxscreenpercentage = 100;
+    // When set, a change needs windowshare percent of the last increasewindowms / decreasewindowms
+    // under or over the band instead of an unbroken run of frames
+    int increasewindowms = 0;
+    int decreasewindowms = 0;
+    int windowshare = 90;
+    // 95 or 99 also counts it as over the band when that percentile of frame time, over the last
+    // tailwindowms, misses the refresh. 0 goes by usage alone. Half the window has to hold at least
+    // 100 frames for p99.
+    int tailpercentile = 0;
+    int tailwindowms = 3000;
+    // This many refreshes missed within a second, with the GPU busy enough to be the cause, count as over
+    // the band whatever usage says. Without a usage reading at all they take the resolution down on their
+    // own. 0 turns it off.
+    int missedframes = 3;
+    // Cascade controller. Inner loop: innerframes missed refreshes in a row take innerstep off, up to
+    // innermaxtrim, and innerrecoveryms without one gives it all back. Outer loop: outside the band
+    // the baseline closes on the middle of it over about outertimems.
+    int innerframes = 2;
+    int innerstep = 3;
+    int innermaxtrim = 12;
+    int innerrecoveryms = 1500;
+    int outertimems = 4000;
+    std::string sensor = "nvml";
+    std::string controller = "step"; // "step" moves by the configured amounts, "predictive" by a learned cost curve, "probe" tests headroom, "cascade" runs fast and slow loops
+    bool telemetry = false; // record a trace of every tick into the game's traces folder
+    bool oscillationdamping = true; // back off increases while the screen percentage keeps cycling
+    bool capdetection = true; // hold the resolution while frames are held to an engine frame cap, e.g. a cutscene's 30 fps
+    bool raiseduringcaps = false; // while capped, raise it as far as uncapped play could sustain instead of holding it
+    bool changedetection = true; // re-acquire the band quickly when the scene's GPU cost shifts
+    bool hitchfilter = true; // leave shader compilation and streaming spikes out of the controller's input
+    bool usecalibration = true; // jump to the level a calibration sweep measured, when there is one for this headset
+};
+
+// Longest window the UI offers. Past about 200 Hz the controller's ring holds less than this,
+// and a window is judged on a full ring instead.
+constexpr int MAX_WINDOW_MS = 5000;
+
+// Only keys that are present and of the right type are applied, a hand edited file may be partial.
+// Values are clamped to what the UI allows, with the usage band at least 5 points wide.
+// Returns false if the file asked for something we had to replace, e.g. an unknown sensor or controller.
+bool apply_settings(const nlohmann::json& j, Settings& settings);
+nlohmann::json settings_to_json(const Settings& settings);
+
+// Profiles match on the executable name, optionally narrowed to a UEVR build by tag or commit hash.
+// A build specific match wins over one that applies to any build. Returns -1 if nothing matches.
+int select_profile(const nlohmann::json& store, const std::string& exe, const std::string& commit, const std::string& tag);
+}
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+#include "Simulator.hpp"
+
+namespace autoscaler {
+Plant::Plant(const PlantParams& params, int screen_percentage)
+    : m_params{ params },
+    m_screen_percentage{ screen_percentage },
+    m_random{ params.seed }
+{
+    if (m_params.scene.empty()) {
+        m_params.scene.push_back(SceneSegment{});
+    }
+
+    m_delay_line.assign(static_cast<size_t>(std::max(m_params.sensor_delay_frames, 0)) + 1, -1);
+}
+
+int Plant::read_usage() {
+    // The oldest entry in the delay line is what the plugin gets to see now
+    return m_delay_line[(m_delay_pos + 1) % m_delay_line.size()];
+}
+
+void Plant::apply(int screen_percentage) {
+    if (screen_percentage != m_screen_percentage) {
+        m_screen_percentage = screen_percentage;
+        m_changed = true;
+    }
+}
+
+SceneSegment Plant::segment_at(double time) const {
+    const auto& scene = m_params.scene;
+
+    // segments are few, a linear search is fine
+    size_t i = 0;
+    while (i + 1 < scene.size() && scene[i + 1].start_seconds <= time) {
+        ++i;
+    }
+
+    auto segment = scene[i];
+
+    if (segment.cpu_ms < 0.0) {
+        segment.cpu_ms = m_params.cpu_ms;
+    }
+
+    segment.rate_divisor = std::max(segment.rate_divisor, 1);
+
+    if (!m_params.ramp_scene || i + 1 >= scene.size() || time < scene[i].start_seconds) {
+        return segment;
+    }
+
+    const auto span = scene[i + 1].start_seconds - scene[i].start_seconds;
+    const auto t = span > 0.0 ? (time - scene[i].start_seconds) / span : 1.0;
+    segment.cost = scene[i].cost + (scene[i + 1].cost - scene[i].cost) * t;
+    return segment;
+}
+
+double Plant::gpu_ms(int screen_percentage, double scene_cost) const {
+    // screen percentage scales each axis, so pixel count goes with its square
+    const auto scale = screen_percentage / 100.0;
+    return m_params.fixed_gpu_ms + m_params.gpu_ms_at_100 * scale * scale * scene_cost;
+}
+
+SimFrame Plant::step() {
+    const auto segment = segment_at(m_time);
+    const auto budget_ms = 1000.0 / m_params.refresh_hz * segment.rate_divisor;
+
+    SimFrame frame{};
+    frame.time = m_time;
+    frame.screen_percentage = m_screen_percentage;
+
+    auto gpu = gpu_ms(m_screen_percentage, segment.cost) * std::max(0.0, 1.0 + m_params.noise * m_random.gaussian());
+
+    if (m_changed) {
+        gpu += m_params.change_hitch_ms;
+        m_changed = false;
+    }
+
+    // Only drawn when enabled, so plants without hitches keep their random sequence
+    if (m_params.hitch_rate > 0.0 && m_random.uniform() < m_params.hitch_rate / m_params.refresh_hz) {
+        gpu += m_params.hitch_ms;
+    }
+
+    frame.gpu_ms = gpu;
+
+    // vsync quantizes the frame to whole frame intervals
+    const auto frame_ms = std::max(gpu, segment.cpu_ms);
+    frame.intervals = std::max(1, static_cast<int>(std::ceil(frame_ms / budget_ms - 1e-9)));
+
+    const auto interval_ms = frame.intervals * budget_ms;
+    frame.delta = interval_ms / 1000.0;
+    m_time += frame.delta;
+
+    // NVML reports how busy the GPU was over its last sampling period
+    m_busy_ms += std::min(gpu, interval_ms);
+    m_window_ms += interval_ms;
+
+    if (m_window_ms >= m_params.sensor_period * 1000.0) {
+        auto usage = m_busy_ms / m_window_ms * 100.0;
+
+        if (m_params.sensor_noise > 0.0) {
+            usage += m_params.sensor_noise * m_random.gaussian();
+        }
+
+        m_sample = static_cast<int>(std::lround(std::clamp(usage, 0.0, 100.0)));
+        m_busy_ms = 0.0;
+        m_window_ms = 0.0;
+    }
+
+    m_delay_pos = (m_delay_pos + 1) % m_delay_line.size();
+    m_delay_line[m_delay_pos] = m_sample;
+
+    frame.usage = read_usage();
+    return frame;
+}
+
+SimulationStats simulate(const PlantParams& params, const Settings& settings, double seconds, int start_screen_percentage,
+    const std::function<void(const SimFrame&, const Decision&)>& on_frame)
+{
+    Plant plant{ params, start_screen_percentage };
+    Controller controller{ settings, start_screen_percentage };
+    Pipeline pipeline{ plant, controller, plant };
+
+    SimulationStats stats{};
+    double screen_percentage_sum = 0.0;
+
+    while (plant.time() < seconds) {
+        const auto frame = plant.step();
+        const auto decision = pipeline.tick(static_cast<float>(frame.delta));
+
+        ++stats.frames;
+        stats.missed_frames += frame.intervals - 1;
+        stats.changes += decision.action != Action::None ? 1 : 0;
+        screen_percentage_sum += frame.screen_percentage * frame.delta;
+
+        if (on_frame) {
+            on_frame(frame, decision);
+        }
+    }
+
+    stats.seconds = plant.time();
+    stats.mean_screen_percentage = stats.seconds > 0.0 ? screen_percentage_sum / stats.seconds : 0.0;
+    return stats;
+}
+
+bool apply_plant_params(const nlohmann::json& j, PlantParams& params) {
+    if (!j.is_object()) {
+        return false;
+    }
+
+    const auto read = [&](const char* key, auto& value) {
+        if (j.contains(key) && j[key].is_number()) {
+            value = j[key].get<std::remove_reference_t<decltype(value)>>();
+        }
+    };
+
+    read("refresh_hz", params.refresh_hz);
+    read("gpu_ms_at_100", params.gpu_ms_at_100);
+    read("fixed_gpu_ms", params.fixed_gpu_ms);
+    read("cpu_ms", params.cpu_ms);
+    read("noise", params.noise);
+    read("sensor_noise", params.sensor_noise);
+    read("pixels_at_100", params.pixels_at_100);
+    read("sensor_delay_frames", params.sensor_delay_frames);
+    read("sensor_period", params.sensor_period);
+    read("change_hitch_ms", params.change_hitch_ms);
+    read("hitch_rate", params.hitch_rate);
+    read("hitch_ms", params.hitch_ms);
+    read("seed", params.seed);
+
+    if (j.contains("ramp_scene") && j["ramp_scene"].is_boolean()) {
+        params.ramp_scene = j["ramp_scene"];
+    }
+
+    if (j.contains("scene") && j["scene"].is_array()) {
+        params.scene.clear();
+
+        for (const auto& segment : j["scene"]) {
+            if (!segment.is_array() || segment.size() < 2 || !segment[0].is_number() || !segment[1].is_number()) {
+                continue;
+            }
+
+            SceneSegment parsed{ segment[0].get<double>(), segment[1].get<double>() };
+
+            if (segment.size() > 2 && segment[2].is_number()) {
+                parsed.cpu_ms = segment[2].get<double>();
+            }
+
+            if (segment.size() > 3 && segment[3].is_number()) {
+                parsed.rate_divisor = segment[3].get<int>();
+            }
+
+            params.scene.push_back(parsed);
+        }
+
+        std::stable_sort(params.scene.begin(), params.scene.end(), [](const auto& a, const auto& b) {
+            return a.start_seconds < b.start_seconds;
+        });
+
+        if (params.scene.empty()) {
+            params.scene.push_back(SceneSegment{});
+        }
+    }
+
+    return params.refresh_hz > 0.0 && params.sensor_period > 0.0;
+}
+
+nlohmann::json plant_params_to_json(const PlantParams& params) {
+    nlohmann::json j;
+    j["refresh_hz"] = params.refresh_hz;
+    j["gpu_ms_at_100"] = params.gpu_ms_at_100;
+    j["fixed_gpu_ms"] = params.fixed_gpu_ms;
+    j["cpu_ms"] = params.cpu_ms;
+    j["noise"] = params.noise;
+    j["sensor_noise"] = params.sensor_noise;
+    j["pixels_at_100"] = params.pixels_at_100;
+    j["sensor_delay_frames"] = params.sensor_delay_frames;
+    j["sensor_period"] = params.sensor_period;
+    j["change_hitch_ms"] = params.change_hitch_ms;
+    j["hitch_rate"] = params.hitch_rate;
+    j["hitch_ms"] = params.hitch_ms;
+    j["seed"] = params.seed;
+    j["ramp_scene"] = params.ramp_scene;
+
+    // [start_seconds, cost, cpu_ms, rate_divisor] arrays keep hand written scenes short,
+    // the trailing entries can be left off when they are at their defaults
+    auto scene = nlohmann::json::array();
+    for (const auto& segment : params.scene) {
+        auto entry = nlohmann::json::array({ segment.start_seconds, segment.cost });
+
+        if (segment.cpu_ms >= 0.0 || segment.rate_divisor != 1) {
+            entry.push_back(segment.cpu_ms);
+        }
+
+        if (segment.rate_divisor != 1) {
+            entry.push_back(segment.rate_divisor);
+        }
+
+        scene.push_back(entry);
+    }
+
+    j["scene"] = scene;
+    return j;
+}
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "Pipeline.hpp"
+#include "Random.hpp"
+
+namespace autoscaler {
+// What the game is doing from start_seconds onwards
+struct SceneSegment {
+    double start_seconds{ 0.0 };
+    double cost{ 1.0 };       // GPU cost multiplier
+    double cpu_ms{ -1.0 };    // overrides PlantParams::cpu_ms when not negative
+    int rate_divisor{ 1 };    // 2 when the runtime throttles to half rate
+};
+
+// A stand-in for the game and GPU, detailed enough to show the failure modes we see in headsets
+struct PlantParams {
+    double refresh_hz{ 90.0 };
+    double gpu_ms_at_100{ 12.0 };     // resolution dependent GPU cost at 100% screen percentage, scales with pixel count
+    double fixed_gpu_ms{ 1.0 };       // resolution independent GPU cost
+    double cpu_ms{ 5.0 };             // game thread cost, frames can't be shorter than this
+    std::vector<SceneSegment> scene{ SceneSegment{} };
+    bool ramp_scene{ false };         // interpolate between segments instead of stepping
+    double noise{ 0.03 };             // relative standard deviation of GPU time per frame
+    double sensor_noise{ 0.0 };       // standard deviation of each reading, in percentage points
+    int sensor_delay_frames{ 2 };     // frames between a sample being taken and the plugin seeing it
+    double sensor_period{ 1.0 / 6.0 }; // NVML averages utilization over this many seconds
+    double change_hitch_ms{ 4.0 };    // extra GPU time on the frame after a screen percentage change
+    double hitch_rate{ 0.0 };         // shader compilation or streaming hitches per second, at random
+    double hitch_ms{ 40.0 };          // extra GPU time of each one
+    double pixels_at_100{ 2.0 * 2064 * 2208 }; // rendered pixels at 100%, both eyes
+    std::uint64_t seed{ 1 };
+};
+
+// What happened on one simulated frame
+struct SimFrame {
+    double time{ 0.0 };
+    double delta{ 0.0 };        // what the engine would pass to on_post_engine_tick
+    double gpu_ms{ 0.0 };
+    int intervals{ 1 };         // frame intervals the frame took, more than 1 means reprojection
+    int screen_percentage{ 0 };
+    int usage{ -1 };            // what the sensor reported after this frame
+};
+
+// The simulated plant. It is both the Sensor and the Actuator the Pipeline drives.
+// Deterministic for a given seed, on every platform.
+class Plant : public Sensor, public Actuator {
+public:
+    Plant(const PlantParams& params, int screen_percentage = 50);
+
+    int read_usage() override;
+    void apply(int screen_percentage) override;
+
+    // Renders one frame at the current screen percentage
+    SimFrame step();
+
+    // The segment in effect at time, with cost interpolated when ramp_scene is set
+    SceneSegment segment_at(double time) const;
+    double scene_cost(double time) const { return segment_at(time).cost; }
+    double gpu_ms(int screen_percentage, double scene_cost) const;
+
+    const PlantParams& params() const { return m_params; }
+    double time() const { return m_time; }
+    int screen_percentage() const { return m_screen_percentage; }
+
+private:
+    PlantParams m_params;
+    double m_time{ 0.0 };
+    int m_screen_percentage;
+    bool m_changed{ false };
+
+    double m_busy_ms{ 0.0 };
+    double m_window_ms{ 0.0 };
+    int m_sample{ -1 };
+    std::vector<int> m_delay_line{};
+    size_t m_delay_pos{ 0 };
+
+    Random m_random;
+};
+
+struct SimulationStats {
+    int frames{ 0 };
+    int missed_frames{ 0 };   // refresh intervals that had no new frame
+    int changes{ 0 };
+    double seconds{ 0.0 };
+    double mean_screen_percentage{ 0.0 };
+};
+
+// Runs the plugin's control loop against a plant for the given simulated time.
+// on_frame, if set, sees every frame together with the controller's decision.
+SimulationStats simulate(const PlantParams& params, const Settings& settings, double seconds, int start_screen_percentage = 50,
+    const std::function<void(const SimFrame&, const Decision&)>& on_frame = {});
+
+bool apply_plant_params(const nlohmann::json& j, PlantParams& params);
+nlohmann::json plant_params_to_json(const PlantParams& params);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace autoscaler {
+// Fixed capacity single producer, single consumer queue. Never allocates and never blocks,
+// push() fails when the consumer has fallen a whole ring behind.
+template <typename T, size_t Capacity>
+class SpscRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer only
+    bool push(const T& value) {
+        const auto head = m_head.load(std::memory_order_relaxed);
+
+        if (head - m_tail.load(std::memory_order_acquire) >= Capacity) {
+            return false;
+        }
+
+        m_items[head & (Capacity - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Calls fn for everything queued so far and returns how many that was.
+    template <typename Fn>
+    size_t drain(Fn&& fn) {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+
+        for (auto i = tail; i != head; ++i) {
+            fn(m_items[i & (Capacity - 1)]);
+        }
+
+        m_tail.store(head, std::memory_order_release);
+        return head - tail;
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    // producer and consumer indices on their own cache lines
+    alignas(64) std::atomic<size_t> m_head{ 0 };
+    alignas(64) std::atomic<size_t> m_tail{ 0 };
+    alignas(64) std::array<T, Capacity> m_items{};
+};
+}
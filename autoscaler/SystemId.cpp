@@ -0,0 +1,466 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Replay.hpp"
+#include "SystemId.hpp"
+
+namespace autoscaler {
+bool PlantIdentifier::add_trace(const std::uint8_t* data, size_t size) {
+    TraceDecoder decoder{ data, size };
+    if (!decoder.valid()) {
+        return false;
+    }
+
+    const auto refresh = estimate_refresh_interval(data, size);
+    if (refresh > 0.0) {
+        m_refresh_intervals.push_back(refresh);
+    }
+
+    std::vector<Tick> ticks{};
+    TraceRecord record{};
+    int rendered_at = -1;
+    int previous_rendered_at = -1;
+    double pixels = 0.0;
+    double seconds = 0.0;
+    int changes = 0;
+    int missed = 0;
+    double block_time = 0.0;
+
+    m_block_seconds.push_back(0.0);
+
+    while (decoder.next(record)) {
+        // a record's screen percentage is what the next frame renders at
+        const auto screen_percentage = rendered_at < 0 ? record.screen_percentage : rendered_at;
+        const auto scale = screen_percentage / 100.0;
+        const auto delta = record.delta_us / 1'000'000.0;
+
+        if (block_time >= BLOCK_SECONDS) {
+            m_block_seconds.push_back(0.0);
+            block_time = 0.0;
+        }
+
+        ticks.push_back({ record.usage, m_block_seconds.size() - 1, pixels, seconds, changes, missed });
+
+        pixels += scale * scale;
+        missed += refresh > 0.0 && delta > refresh * 1.5 ? 1 : 0;
+        seconds += delta;
+        changes += previous_rendered_at >= 0 && screen_percentage != previous_rendered_at ? 1 : 0;
+
+        block_time += delta;
+        m_block_seconds.back() += delta;
+        previous_rendered_at = screen_percentage;
+        rendered_at = record.screen_percentage;
+    }
+
+    ticks.push_back({ -1, m_block_seconds.size() - 1, pixels, seconds, changes, missed });
+    m_traces.push_back(std::move(ticks));
+    return true;
+}
+
+namespace {
+// The window behind one fresh reading
+struct Reading {
+    size_t trace;
+    size_t tick;
+    size_t windows;  // since the previous fresh reading, more than 1 when readings repeated, 0 for the first
+    size_t block;
+    double pixels;   // mean over the window's frames
+    double hitches;  // changes per frame in the window
+    double gpu_ms;   // mean GPU time per frame
+    double frames;
+    bool missed;     // every frame missed its interval
+};
+
+// Sums for GPU time = fixed + hitch * hitches + slope * pixels within one block
+struct Sums {
+    double n{ 0.0 }, h{ 0.0 }, hh{ 0.0 };
+    double x{ 0.0 }, xh{ 0.0 }, xx{ 0.0 };
+    double y{ 0.0 }, hy{ 0.0 }, xy{ 0.0 }, yy{ 0.0 };
+
+    void add(const Reading& r) {
+        n += 1.0;
+        h += r.hitches;
+        hh += r.hitches * r.hitches;
+        x += r.pixels;
+        xh += r.pixels * r.hitches;
+        xx += r.pixels * r.pixels;
+        y += r.gpu_ms;
+        hy += r.hitches * r.gpu_ms;
+        xy += r.pixels * r.gpu_ms;
+        yy += r.gpu_ms * r.gpu_ms;
+    }
+};
+
+struct Model {
+    double fixed{ 0.0 };
+    double hitch{ 0.0 };
+    std::vector<double> slopes{};
+    double r_squared{ -1.0 };
+    int readings{ 0 };
+};
+
+// For given shared costs each block's slope has a closed form, which leaves a 2x2 least squares
+// problem for the shared ones
+Model fit_model(const std::vector<Reading>& readings, size_t blocks) {
+    Model model{};
+    std::vector<Sums> sums(blocks);
+    Sums all{};
+
+    // Frames that only just miss their interval are the ones that came out slow, so which
+    // windows miss depends on their noise. They'd bias the shared costs and sit out.
+    for (const auto& r : readings) {
+        if (!r.missed) {
+            sums[r.block].add(r);
+            all.add(r);
+        }
+    }
+
+    const auto total = all.n > 1.0 ? all.yy - all.y * all.y / all.n : 0.0;
+    if (total <= 0.0) {
+        return model;
+    }
+
+    double a00 = 0.0, a01 = 0.0, a11 = 0.0, c0 = 0.0, c1 = 0.0;
+
+    for (const auto& s : sums) {
+        if (s.xx <= 0.0) {
+            continue;
+        }
+
+        a00 += s.n - s.x * s.x / s.xx;
+        a01 += s.h - s.x * s.xh / s.xx;
+        a11 += s.hh - s.xh * s.xh / s.xx;
+        c0 += s.y - s.x * s.xy / s.xx;
+        c1 += s.hy - s.xh * s.xy / s.xx;
+    }
+
+    const auto det = a00 * a11 - a01 * a01;
+
+    if (std::abs(det) > 1e-9 * std::max(1.0, a00 * a11)) {
+        model.fixed = (c0 * a11 - c1 * a01) / det;
+        model.hitch = (a00 * c1 - a01 * c0) / det;
+    }
+    else if (a00 > 1e-6 * all.n) {
+        // no changes to measure a hitch on
+        model.fixed = c0 / a00;
+    }
+
+    // resolution that never moves within a block can't tell fixed from pixel cost, fixed stays 0
+
+    double residual = 0.0;
+    model.slopes.assign(blocks, 0.0);
+
+    for (size_t b = 0; b < blocks; ++b) {
+        const auto& s = sums[b];
+        if (s.xx <= 0.0) {
+            continue;
+        }
+
+        const auto cross = s.xy - model.fixed * s.x - model.hitch * s.xh;
+        model.slopes[b] = cross / s.xx;
+
+        const auto shared = s.yy - 2.0 * (model.fixed * s.y + model.hitch * s.hy)
+            + model.fixed * model.fixed * s.n + 2.0 * model.fixed * model.hitch * s.h + model.hitch * model.hitch * s.hh;
+
+        residual += shared - cross * cross / s.xx;
+    }
+
+    model.r_squared = 1.0 - residual / total;
+    model.readings = static_cast<int>(all.n);
+    return model;
+}
+}
+
+PlantFit PlantIdentifier::fit() const {
+    PlantFit fit{};
+    auto& params = fit.params;
+
+    if (!m_refresh_intervals.empty()) {
+        auto intervals = m_refresh_intervals;
+        std::sort(intervals.begin(), intervals.end());
+        params.refresh_hz = 1.0 / intervals[intervals.size() / 2];
+    }
+
+    const auto refresh_ms = 1000.0 / params.refresh_hz;
+
+    // A reading holds until the next NVML window closes, so the most common time between
+    // changes of the reading is one window. Neighbouring windows that happen to read the
+    // same only make some runs longer. 1ms buckets.
+    std::vector<int> run_counts(1000, 0);
+    std::vector<double> run_sums(1000, 0.0);
+
+    for (const auto& ticks : m_traces) {
+        size_t run_start = 0;
+
+        for (size_t i = 1; i + 1 < ticks.size(); ++i) {
+            if (ticks[i].usage == ticks[i - 1].usage) {
+                continue;
+            }
+
+            // the first run started before the trace did
+            const auto length = ticks[i].seconds_before - ticks[run_start].seconds_before;
+            const auto bucket = static_cast<size_t>(length * 1000.0);
+
+            if (run_start > 0 && bucket < run_counts.size()) {
+                ++run_counts[bucket];
+                run_sums[bucket] += length;
+            }
+
+            run_start = i;
+        }
+    }
+
+    const auto mode = static_cast<size_t>(std::max_element(run_counts.begin(), run_counts.end()) - run_counts.begin());
+    if (run_counts[mode] == 0) {
+        return fit;
+    }
+
+    params.sensor_period = run_sums[mode] / run_counts[mode];
+
+    // A fresh reading describes the window of frames up to the one it closed on, the delay
+    // before it showed up
+    const auto readings_at = [&](size_t delay) {
+        std::vector<Reading> readings{};
+
+        for (size_t trace = 0; trace < m_traces.size(); ++trace) {
+            const auto& ticks = m_traces[trace];
+            size_t previous = 0;
+
+            for (auto r = delay + 1; r + 1 < ticks.size(); ++r) {
+                const auto usage = ticks[r].usage;
+
+                if (usage == ticks[r - 1].usage) {
+                    continue;
+                }
+
+                const auto start = previous;
+                const auto since = ticks[r].seconds_before - ticks[start].seconds_before;
+                const auto windows = start > 0 ? std::max<size_t>(1, static_cast<size_t>(std::lround(since / params.sensor_period))) : 0;
+                previous = r;
+
+                const auto& end = ticks[r - delay + 1];
+
+                if (usage <= 0 || usage >= 100) {
+                    continue;
+                }
+
+                // Right after the previous reading the window starts where that one's ended. Otherwise
+                // go back one period, to the nearest whole frame as deltas are rounded to microseconds.
+                auto first = ticks.begin();
+
+                if (windows == 1 && start >= delay) {
+                    first += static_cast<std::ptrdiff_t>(start + 1 - delay);
+                }
+                else {
+                    const auto opened = end.seconds_before - params.sensor_period + refresh_ms / 2000.0;
+                    if (opened < 0.0) {
+                        continue;
+                    }
+
+                    first = std::prev(std::upper_bound(ticks.begin(), ticks.begin() + static_cast<std::ptrdiff_t>(r - delay + 1), opened,
+                        [](double seconds, const Tick& tick) { return seconds < tick.seconds_before; }));
+                }
+
+                const auto frames = static_cast<double>(&end - &*first);
+
+                // where frames start or stop missing their interval the window boundaries are anyone's guess
+                const auto missed = end.missed_before - first->missed_before;
+                if (missed != 0 && missed != static_cast<int>(frames)) {
+                    continue;
+                }
+
+                readings.push_back({ trace, r, windows, ticks[r - delay].block, (end.pixels_before - first->pixels_before) / frames,
+                    (end.changes_before - first->changes_before) / frames,
+                    usage / 100.0 * (end.seconds_before - first->seconds_before) * 1000.0 / frames, frames, missed != 0 });
+            }
+        }
+
+        return readings;
+    };
+
+    const auto blocks = m_block_seconds.size();
+    Model model{};
+    size_t delay = 0;
+
+    for (size_t d = 0; d <= MAX_DELAY_FRAMES; ++d) {
+        auto candidate = fit_model(readings_at(d), blocks);
+
+        if (candidate.r_squared > model.r_squared) {
+            model = std::move(candidate);
+            delay = d;
+        }
+    }
+
+    if (model.readings == 0) {
+        return fit;
+    }
+
+    const auto readings = readings_at(delay);
+
+    // Blocks spent missing frames still tell us the scene's cost once the shared costs are known
+    {
+        std::vector<double> xy(blocks, 0.0);
+        std::vector<double> xx(blocks, 0.0);
+
+        for (const auto& r : readings) {
+            if (r.missed && model.slopes[r.block] == 0.0) {
+                xy[r.block] += r.pixels * (r.gpu_ms - model.fixed - model.hitch * r.hitches);
+                xx[r.block] += r.pixels * r.pixels;
+            }
+        }
+
+        for (size_t b = 0; b < blocks; ++b) {
+            if (xx[b] > 0.0) {
+                model.slopes[b] = xy[b] / xx[b];
+            }
+        }
+    }
+
+    fit.readings = model.readings;
+    fit.r_squared = model.r_squared;
+    params.sensor_delay_frames = static_cast<int>(delay);
+    params.fixed_gpu_ms = std::max(0.0, model.fixed);
+
+    double frames = 0.0;
+
+    for (const auto& r : readings) {
+        if (!r.missed) {
+            fit.changes += static_cast<int>(std::lround(r.hitches * r.frames));
+            frames += r.frames;
+        }
+    }
+
+    if (fit.changes > 0) {
+        params.change_hitch_ms = std::max(0.0, model.hitch);
+    }
+
+    // The average block is a scene cost of 1, the blocks in order are the scene
+    double slope_seconds = 0.0;
+    double measured_seconds = 0.0;
+
+    for (size_t b = 0; b < blocks; ++b) {
+        if (model.slopes[b] > 0.0) {
+            slope_seconds += model.slopes[b] * m_block_seconds[b];
+            measured_seconds += m_block_seconds[b];
+        }
+    }
+
+    params.gpu_ms_at_100 = measured_seconds > 0.0 ? slope_seconds / measured_seconds : 0.0;
+    params.scene.clear();
+
+    double start = 0.0;
+
+    for (size_t b = 0; b < blocks; ++b) {
+        // blocks without a usable reading keep the cost before them
+        if (model.slopes[b] > 0.0 && params.gpu_ms_at_100 > 0.0) {
+            params.scene.push_back({ start, model.slopes[b] / params.gpu_ms_at_100 });
+        }
+
+        start += m_block_seconds[b];
+    }
+
+    if (params.scene.empty()) {
+        params.scene.push_back(SceneSegment{});
+    }
+
+    params.scene.front().start_seconds = 0.0;
+
+    // Residuals of consecutive windows. Windows that repeated the reading before them never
+    // showed up as fresh readings, they count as repeating its residual too.
+    std::vector<std::vector<double>> runs{};
+    double predicted_sum = 0.0;
+
+    int predicted_count = 0;
+
+    for (size_t i = 0; i < readings.size(); ++i) {
+        const auto& r = readings[i];
+        if (r.missed) {
+            continue;
+        }
+
+        const auto predicted = model.fixed + model.hitch * r.hitches + model.slopes[r.block] * r.pixels;
+        predicted_sum += predicted;
+        ++predicted_count;
+
+        const auto follows = i > 0 && readings[i - 1].trace == r.trace && !readings[i - 1].missed && r.windows > 0 && r.windows <= 4;
+
+        if (!follows || runs.empty()) {
+            runs.emplace_back();
+        }
+        else {
+            runs.back().insert(runs.back().end(), r.windows - 1, runs.back().back());
+        }
+
+        runs.back().push_back(r.gpu_ms - predicted);
+    }
+
+    double difference_sum = 0.0;
+    int difference_count = 0;
+
+    for (const auto& run : runs) {
+        for (size_t k = 1; k < run.size(); ++k) {
+            difference_sum += (run[k] - run[k - 1]) * (run[k] - run[k - 1]);
+            ++difference_count;
+        }
+    }
+
+    if (difference_count > 0 && predicted_sum > 0.0) {
+        // readings are whole percent, take out the rounding's share of the variance
+        const auto rounding = refresh_ms / 100.0;
+        const auto window_variance = std::max(0.0, difference_sum / difference_count / 2.0 - rounding * rounding / 12.0);
+
+        params.noise = std::sqrt(window_variance * frames / predicted_count) / (predicted_sum / predicted_count);
+    }
+
+    // Periodogram of the residuals over 64 reading segments with a Hann window, in octaves
+    constexpr size_t SEGMENT = 64;
+    std::vector<double> power(SEGMENT / 2 + 1, 0.0);
+
+    for (const auto& run : runs) {
+        for (size_t start = 0; start + SEGMENT <= run.size(); start += SEGMENT / 2) {
+            double mean = 0.0;
+            for (size_t k = 0; k < SEGMENT; ++k) {
+                mean += run[start + k];
+            }
+
+            mean /= SEGMENT;
+
+            for (size_t bin = 1; bin < power.size(); ++bin) {
+                double re = 0.0, im = 0.0;
+
+                for (size_t k = 0; k < SEGMENT; ++k) {
+                    const auto hann = 0.5 - 0.5 * std::cos(6.283185307179586 * k / (SEGMENT - 1));
+                    const auto angle = 6.283185307179586 * bin * k / SEGMENT;
+                    const auto v = (run[start + k] - mean) * hann;
+                    re += v * std::cos(angle);
+                    im -= v * std::sin(angle);
+                }
+
+                power[bin] += re * re + im * im;
+            }
+        }
+    }
+
+    double total_power = 0.0;
+    for (size_t bin = 1; bin < power.size(); ++bin) {
+        total_power += power[bin];
+    }
+
+    if (total_power > 0.0) {
+        const auto bin_hz = 1.0 / (params.sensor_period * SEGMENT);
+
+        for (auto high = power.size() - 1; high >= 1; high /= 2) {
+            const auto low = high / 2 + 1;
+            NoiseBand band{ low * bin_hz, high * bin_hz, 0.0 };
+
+            for (auto bin = low; bin <= high; ++bin) {
+                band.share += power[bin] / total_power;
+            }
+
+            fit.noise_spectrum.push_back(band);
+        }
+    }
+
+    return fit;
+}
+}
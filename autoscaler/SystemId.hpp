@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "Simulator.hpp"
+
+namespace autoscaler {
+// Share of the sensor residual's power in one octave of frequency
+struct NoiseBand {
+    double low_hz{ 0.0 };
+    double high_hz{ 0.0 };
+    double share{ 0.0 };
+};
+
+struct PlantFit {
+    PlantParams params{};           // ready for the simulator, fields the traces can't tell us keep their defaults
+    int readings{ 0 };              // sensor readings the model was fitted to
+    double r_squared{ 0.0 };        // of the model against those readings
+    int changes{ 0 };               // resolution changes inside those readings' windows, what the hitch is measured on
+    std::vector<NoiseBand> noise_spectrum{}; // highest octave first
+};
+
+// Fits a plant model to one or more recorded traces of the same game.
+//
+// Each fresh sensor reading is the GPU's busy share over the NVML window that closed the
+// sensor delay before it, so times the window's mean delta it is the mean GPU time of the
+// frames in that window. That is modelled as a fixed cost, plus a pixel dependent cost times
+// the window's mean squared screen percentage, plus a hitch for each change in the window.
+//
+// - The controller lowers resolution exactly when the scene gets heavier, so a single slope
+//   through all of it would say pixels are nearly free. Every 10 seconds get their own slope
+//   instead, fixed and hitch cost are shared, and the slopes become the exported scene.
+// - The delay is the one whose windows fit best. A reading's noise is its own window's, which
+//   the decisions that set that window's resolution never saw, so the closed loop doesn't
+//   bias the fit the way it would with every tick.
+// - Per-frame noise comes from the spread between back to back readings' residuals, scaled up
+//   by the window length. Differencing keeps slow scene drift from passing for noise.
+//
+// Readings of 100% hide how much more GPU time the frames wanted and are left out, and so are
+// windows where frames started or stopped missing their interval.
+class PlantIdentifier {
+public:
+    // Returns false if the data isn't a trace
+    bool add_trace(const std::uint8_t* data, size_t size);
+
+    PlantFit fit() const;
+
+private:
+    struct Tick {
+        int usage;
+        size_t block;
+        // running totals up to and excluding this tick, so any window is a subtraction
+        double pixels_before;   // of (screen percentage / 100)^2 each frame rendered at
+        double seconds_before;
+        int changes_before;     // frames rendered at a different screen percentage than the one before
+        int missed_before;      // frames that took more than one refresh interval
+    };
+
+    static constexpr int MAX_DELAY_FRAMES = 60;
+    static constexpr double BLOCK_SECONDS = 10.0; // scene cost is taken as constant for this long
+
+    std::vector<std::vector<Tick>> m_traces{};     // one extra tick at the end closes the totals
+    std::vector<double> m_block_seconds{};         // length of every block, across all traces
+    std::vector<double> m_refresh_intervals{};
+};
+}
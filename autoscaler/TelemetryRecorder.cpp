@@ -0,0 +1,116 @@
+#include <algorithm>
+#include <fstream>
+#include <string>
+
+#include "TelemetryRecorder.hpp"
+
+namespace autoscaler {
+TelemetryRecorder::TelemetryRecorder(std::filesystem::path path, std::chrono::milliseconds flush_interval, std::uintmax_t max_bytes, int max_files)
+    : m_path{ std::move(path) },
+    m_flush_interval{ flush_interval },
+    m_max_bytes{ max_bytes },
+    m_max_files{ std::max(max_files, 1) },
+    m_thread{ [this] { run(); } }
+{
+}
+
+TelemetryRecorder::~TelemetryRecorder() {
+    close();
+    m_thread.join();
+}
+
+void TelemetryRecorder::close() {
+    {
+        std::scoped_lock _{ m_mutex };
+        m_stopping = true;
+    }
+
+    m_cv.notify_one();
+}
+
+std::filesystem::path TelemetryRecorder::segment_path(int segment) const {
+    if (segment <= 1) {
+        return m_path;
+    }
+
+    auto path = m_path;
+    path.replace_filename(m_path.stem().string() + "-" + std::to_string(segment) + m_path.extension().string());
+    return path;
+}
+
+void TelemetryRecorder::run() {
+    std::error_code ec{};
+    std::filesystem::create_directories(m_path.parent_path(), ec);
+
+    int segment = 1;
+    std::uintmax_t written = 0;
+    std::ofstream file(m_path, std::ios::binary | std::ios::trunc);
+
+    if (!file.is_open()) {
+        m_failed = true;
+    }
+
+    // Every file starts with a header and a fresh encoder, so each one reads back on its own
+    TraceEncoder encoder{};
+    std::vector<std::uint8_t> buffer = TraceEncoder::header();
+    buffer.reserve(64 * 1024);
+
+    const auto next_file = [&] {
+        file.close();
+        ++segment;
+        written = 0;
+
+        if (segment > m_max_files) {
+            std::filesystem::remove(segment_path(segment - m_max_files), ec);
+        }
+
+        file.open(segment_path(segment), std::ios::binary | std::ios::trunc);
+
+        if (!file.is_open()) {
+            m_failed = true;
+        }
+
+        encoder = TraceEncoder{};
+        buffer = TraceEncoder::header();
+    };
+
+    std::unique_lock lock{ m_mutex };
+
+    while (true) {
+        const auto stopping = m_cv.wait_for(lock, m_flush_interval, [this] { return m_stopping; });
+
+        lock.unlock();
+
+        const auto write = [&] {
+            if (file.is_open() && !buffer.empty()) {
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+                written += buffer.size();
+
+                if (!file.good()) {
+                    m_failed = true;
+                }
+            }
+
+            buffer.clear();
+        };
+
+        m_ring.drain([&](const TraceRecord& record) {
+            if (written + buffer.size() >= m_max_bytes) {
+                write();
+                next_file();
+            }
+
+            encoder.encode(record, buffer);
+        });
+
+        write();
+        file.flush();
+
+        if (stopping) {
+            return;
+        }
+
+        lock.lock();
+    }
+}
+}
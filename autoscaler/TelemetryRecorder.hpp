@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+
+#include "SpscRing.hpp"
+#include "Trace.hpp"
+
+namespace autoscaler {
+// Records one TraceRecord per tick into a preallocated ring, a background thread encodes
+// them and appends them to a trace file. record() is a handful of stores and never blocks,
+// if the writer falls a whole ring behind records are dropped and counted instead.
+// Once a file reaches max_bytes the writer carries on in a new one, path with -2, -3... added
+// to its name, each a complete trace of its own. Only the newest max_files are kept.
+class TelemetryRecorder {
+public:
+    // The file is created on the writer thread, not the caller's
+    TelemetryRecorder(std::filesystem::path path, std::chrono::milliseconds flush_interval = std::chrono::milliseconds{ 250 },
+        std::uintmax_t max_bytes = 16 * 1024 * 1024, int max_files = 4);
+    // Waits for the writer to finish, call close() first to not wait on its last write
+    ~TelemetryRecorder();
+
+    // Asks the writer to write what's left and close the file on its own thread, never blocks
+    void close();
+
+    // Producer thread only
+    void record(const TraceRecord& record) {
+        if (!m_ring.push(record)) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    size_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+    bool failed() const { return m_failed.load(std::memory_order_relaxed); }
+    // The first file, later ones are named after it
+    const std::filesystem::path& path() const { return m_path; }
+    std::filesystem::path segment_path(int segment) const;
+
+private:
+    void run();
+
+    // ~4 seconds at 1000 fps between flushes
+    SpscRing<TraceRecord, 4096> m_ring{};
+    std::atomic<size_t> m_dropped{ 0 };
+    std::atomic<bool> m_failed{ false };
+
+    std::filesystem::path m_path;
+    std::chrono::milliseconds m_flush_interval;
+    std::uintmax_t m_max_bytes;
+    int m_max_files;
+    std::mutex m_mutex{};
+    std::condition_variable m_cv{};
+    bool m_stopping{ false };
+    std::thread m_thread;
+};
+}
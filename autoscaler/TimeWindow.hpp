@@ -0,0 +1,158 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace autoscaler {
+// The most recent values, each with the time it covered, in a fixed capacity ring. Never allocates.
+// Statistics are taken over the newest span seconds, so one window can serve rules of different lengths.
+template <size_t Capacity>
+class TimeWindow {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Entries older than span seconds are dropped, as is the oldest one when the ring is full
+    explicit TimeWindow(float span = 1.0f)
+        : m_span{ span }
+    {
+    }
+
+    void set_span(float span) { m_span = span; }
+
+    void push(float seconds, float value) {
+        if (m_count == Capacity) {
+            pop();
+        }
+
+        m_items[(m_head + m_count) & (Capacity - 1)] = { seconds, value };
+        ++m_count;
+        m_seconds += seconds;
+
+        while (m_count > 1 && m_seconds - m_items[m_head].seconds >= m_span) {
+            pop();
+        }
+    }
+
+    void clear() {
+        m_head = 0;
+        m_count = 0;
+        m_seconds = 0.0;
+    }
+
+    size_t size() const { return m_count; }
+    // Holding all it can, the oldest entries are now dropped to make room rather than for their age
+    bool full() const { return m_count == Capacity; }
+    // Time covered by everything held, at most a little over the span
+    float seconds() const { return static_cast<float>(m_seconds); }
+
+    // Share of the newest span seconds, by time, spent at or below / at or above value
+    float share_at_or_below(float value, float span) const {
+        return share(span, [value](float v) { return v <= value; });
+    }
+
+    float share_at_or_above(float value, float span) const {
+        return share(span, [value](float v) { return v >= value; });
+    }
+
+    // Sum of the values of the newest span seconds
+    float sum(float span) const {
+        auto covered = 0.0f;
+        auto total = 0.0f;
+
+        for (size_t i = 0; i < m_count && covered < span; ++i) {
+            const auto& entry = from_newest(i);
+            covered += entry.seconds;
+            total += entry.value;
+        }
+
+        return total;
+    }
+
+    float median(float span) const {
+        const auto n = newest(span);
+
+        if (n == 0) {
+            return 0.0f;
+        }
+
+        const auto middle = m_scratch.begin() + n / 2;
+        std::nth_element(m_scratch.begin(), middle, m_scratch.begin() + n);
+        return *middle;
+    }
+
+    // Mean of the newest span seconds with the lowest and highest trim share of values left out
+    float trimmed_mean(float span, float trim) const {
+        const auto n = newest(span);
+
+        if (n == 0) {
+            return 0.0f;
+        }
+
+        std::sort(m_scratch.begin(), m_scratch.begin() + n);
+
+        const auto cut = std::min(static_cast<size_t>(n * trim), (n - 1) / 2);
+        auto sum = 0.0f;
+
+        for (auto i = cut; i < n - cut; ++i) {
+            sum += m_scratch[i];
+        }
+
+        return sum / (n - 2 * cut);
+    }
+
+private:
+    struct Entry {
+        float seconds;
+        float value;
+    };
+
+    void pop() {
+        m_seconds -= m_items[m_head].seconds;
+        m_head = (m_head + 1) & (Capacity - 1);
+        --m_count;
+    }
+
+    const Entry& from_newest(size_t i) const {
+        return m_items[(m_head + m_count - 1 - i) & (Capacity - 1)];
+    }
+
+    template <typename Pred>
+    float share(float span, Pred pred) const {
+        auto covered = 0.0f;
+        auto matching = 0.0f;
+
+        for (size_t i = 0; i < m_count && covered < span; ++i) {
+            const auto& entry = from_newest(i);
+            covered += entry.seconds;
+
+            if (pred(entry.value)) {
+                matching += entry.seconds;
+            }
+        }
+
+        return covered > 0.0f ? matching / covered : 0.0f;
+    }
+
+    // Copies the values of the newest span seconds into the scratch buffer and returns how many
+    size_t newest(float span) const {
+        auto covered = 0.0f;
+        size_t n = 0;
+
+        while (n < m_count && covered < span) {
+            const auto& entry = from_newest(n);
+            covered += entry.seconds;
+            m_scratch[n++] = entry.value;
+        }
+
+        return n;
+    }
+
+    float m_span;
+    std::array<Entry, Capacity> m_items{};
+    size_t m_head{ 0 };
+    size_t m_count{ 0 };
+    double m_seconds{ 0.0 }; // a running sum, double so hours of pushes and pops don't drift
+    mutable std::array<float, Capacity> m_scratch{};
+};
+}
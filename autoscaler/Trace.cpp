@@ -0,0 +1,295 @@
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "Trace.hpp"
+
+namespace autoscaler {
+namespace {
+constexpr char MAGIC[8] = { 'A', 'S', 'T', 'R', 'A', 'C', 'E', '\0' };
+constexpr std::uint32_t VERSION = 1;
+
+struct Channel {
+    const char* name;
+    std::int64_t (*get)(const TraceRecord&);
+    void (*set)(TraceRecord&, std::int64_t);
+};
+
+// Append new channels at the end, existing names must keep their meaning
+const Channel CHANNELS[] = {
+    { "time_us", [](const TraceRecord& r) -> std::int64_t { return r.time_us; }, [](TraceRecord& r, std::int64_t v) { r.time_us = v; } },
+    { "delta_us", [](const TraceRecord& r) -> std::int64_t { return r.delta_us; }, [](TraceRecord& r, std::int64_t v) { r.delta_us = v; } },
+    { "usage", [](const TraceRecord& r) -> std::int64_t { return r.usage; }, [](TraceRecord& r, std::int64_t v) { r.usage = static_cast<int>(v); } },
+    { "band", [](const TraceRecord& r) -> std::int64_t { return static_cast<std::int64_t>(r.band); }, [](TraceRecord& r, std::int64_t v) { r.band = static_cast<Band>(v); } },
+    { "action", [](const TraceRecord& r) -> std::int64_t { return static_cast<std::int64_t>(r.action); }, [](TraceRecord& r, std::int64_t v) { r.action = static_cast<Action>(v); } },
+    { "screen_percentage", [](const TraceRecord& r) -> std::int64_t { return r.screen_percentage; }, [](TraceRecord& r, std::int64_t v) { r.screen_percentage = static_cast<int>(v); } },
+    { "frame_p95_us", [](const TraceRecord& r) -> std::int64_t { return r.frame_p95_us; }, [](TraceRecord& r, std::int64_t v) { r.frame_p95_us = v; } },
+    { "frame_p99_us", [](const TraceRecord& r) -> std::int64_t { return r.frame_p99_us; }, [](TraceRecord& r, std::int64_t v) { r.frame_p99_us = v; } },
+    { "hitch", [](const TraceRecord& r) -> std::int64_t { return static_cast<std::int64_t>(r.hitch); }, [](TraceRecord& r, std::int64_t v) { r.hitch = static_cast<Hitch>(v); } },
+    { "damping", [](const TraceRecord& r) -> std::int64_t { return r.damping; }, [](TraceRecord& r, std::int64_t v) { r.damping = static_cast<int>(v); } },
+    { "missed", [](const TraceRecord& r) -> std::int64_t { return r.missed; }, [](TraceRecord& r, std::int64_t v) { r.missed = static_cast<int>(v); } },
+    { "present_us", [](const TraceRecord& r) -> std::int64_t { return r.present_us; }, [](TraceRecord& r, std::int64_t v) { r.present_us = v; } },
+    { "capped", [](const TraceRecord& r) -> std::int64_t { return r.capped; }, [](TraceRecord& r, std::int64_t v) { r.capped = v != 0; } },
+};
+
+constexpr size_t CHANNEL_COUNT = sizeof(CHANNELS) / sizeof(CHANNELS[0]);
+
+// Deltas start from a default record, so channels a reader doesn't have stay at their defaults
+std::vector<std::int64_t> default_values() {
+    const TraceRecord defaults{};
+    std::vector<std::int64_t> values(CHANNEL_COUNT);
+
+    for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+        values[i] = CHANNELS[i].get(defaults);
+    }
+
+    return values;
+}
+
+void put_u32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+}
+
+void put_varint(std::vector<std::uint8_t>& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(static_cast<std::uint8_t>(value));
+}
+
+std::uint64_t zigzag(std::int64_t value) {
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value) {
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+}
+
+TraceEncoder::TraceEncoder()
+    : m_previous{ default_values() }
+{
+}
+
+std::vector<std::uint8_t> TraceEncoder::header() {
+    std::vector<std::uint8_t> out(std::begin(MAGIC), std::end(MAGIC));
+    put_u32(out, VERSION);
+    put_u32(out, static_cast<std::uint32_t>(CHANNEL_COUNT));
+
+    for (const auto& channel : CHANNELS) {
+        const auto length = std::strlen(channel.name);
+        out.push_back(static_cast<std::uint8_t>(length));
+        out.insert(out.end(), channel.name, channel.name + length);
+    }
+
+    return out;
+}
+
+void TraceEncoder::encode(const TraceRecord& record, std::vector<std::uint8_t>& out) {
+    for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+        const auto value = CHANNELS[i].get(record);
+        put_varint(out, zigzag(value - m_previous[i]));
+        m_previous[i] = value;
+    }
+}
+
+TraceDecoder::TraceDecoder(const std::uint8_t* data, size_t size)
+    : m_data{ data },
+    m_end{ data + size },
+    m_values{ default_values() }
+{
+    if (size < sizeof(MAGIC) + 8 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        return;
+    }
+
+    m_data += sizeof(MAGIC);
+
+    const auto read_u32 = [this] {
+        std::uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<std::uint32_t>(m_data[i]) << (i * 8);
+        }
+
+        m_data += 4;
+        return value;
+    };
+
+    const auto version = read_u32();
+    const auto channel_count = read_u32();
+
+    if (version != VERSION) {
+        return;
+    }
+
+    for (std::uint32_t i = 0; i < channel_count; ++i) {
+        if (m_data >= m_end || m_end - m_data < 1 + *m_data) {
+            return;
+        }
+
+        const std::string name(reinterpret_cast<const char*>(m_data + 1), *m_data);
+        m_data += 1 + *m_data;
+
+        int mapped = -1;
+        for (size_t c = 0; c < CHANNEL_COUNT; ++c) {
+            if (name == CHANNELS[c].name) {
+                mapped = static_cast<int>(c);
+                break;
+            }
+        }
+
+        m_channel_map.push_back(mapped);
+    }
+
+    m_raw.resize(m_channel_map.size());
+    m_valid = true;
+}
+
+bool TraceDecoder::read_varint(std::uint64_t& value) {
+    value = 0;
+
+    for (int shift = 0; shift < 64 && m_data < m_end; shift += 7) {
+        const auto byte = *m_data++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool TraceDecoder::next(TraceRecord& record) {
+    if (!m_valid || m_data >= m_end) {
+        return false;
+    }
+
+    // Read the whole record before applying it, so a truncated one leaves the state untouched
+    for (auto& raw : m_raw) {
+        if (!read_varint(raw)) {
+            m_data = m_end;
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < m_channel_map.size(); ++i) {
+        if (m_channel_map[i] >= 0) {
+            m_values[m_channel_map[i]] += unzigzag(m_raw[i]);
+        }
+    }
+
+    for (size_t i = 0; i < CHANNEL_COUNT; ++i) {
+        CHANNELS[i].set(record, m_values[i]);
+    }
+
+    return true;
+}
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    m_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE) {
+        m_file = nullptr;
+        return;
+    }
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(m_file, &size);
+    m_size = static_cast<size_t>(size.QuadPart);
+    m_opened = true;
+
+    if (m_size == 0) {
+        return;
+    }
+
+    m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping == nullptr) {
+        m_opened = false;
+        return;
+    }
+
+    m_data = static_cast<const std::uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    m_opened = m_data != nullptr;
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+
+    if (m_file != nullptr) {
+        CloseHandle(m_file);
+    }
+}
+#else
+MappedFile::MappedFile(const std::filesystem::path& path) {
+    const auto fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) == 0) {
+        m_size = static_cast<size_t>(st.st_size);
+        m_opened = true;
+
+        if (m_size > 0) {
+            auto mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (mapped == MAP_FAILED) {
+                m_opened = false;
+            }
+            else {
+                // traces are read front to back
+                madvise(mapped, m_size, MADV_SEQUENTIAL);
+                m_data = static_cast<const std::uint8_t*>(mapped);
+            }
+        }
+    }
+
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (m_data != nullptr) {
+        munmap(const_cast<std::uint8_t*>(m_data), m_size);
+    }
+}
+#endif
+
+bool read_trace(const std::filesystem::path& path, std::vector<TraceRecord>& records) {
+    const MappedFile file{ path };
+    if (!file.is_open()) {
+        return false;
+    }
+
+    TraceDecoder decoder{ file.data(), file.size() };
+    if (!decoder.valid()) {
+        return false;
+    }
+
+    TraceRecord record{};
+    while (decoder.next(record)) {
+        records.push_back(record);
+    }
+
+    return true;
+}
+}
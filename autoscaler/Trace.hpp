@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "Controller.hpp"
+
+namespace autoscaler {
+// Everything we know about one engine tick
+struct TraceRecord {
+    std::int64_t time_us{ 0 };  // since the recording started
+    std::int64_t delta_us{ 0 }; // engine delta
+    int usage{ -1 };
+    Band band{ Band::NoReading };
+    Action action{ Action::None };
+    int screen_percentage{ 0 };
+    std::int64_t frame_p95_us{ 0 }; // engine delta percentiles, over the controller's tail window
+    std::int64_t frame_p99_us{ 0 };
+    Hitch hitch{ Hitch::None };
+    int damping{ 0 }; // level of limit cycle damping
+    int missed{ 0 };  // refreshes the frame missed, going by the deltas
+    std::int64_t present_us{ 0 }; // longest time between the runtime's presents since the previous tick, 0 without one
+    bool capped{ false }; // frames were held to an engine frame cap
+};
+
+// Trace files are a small header followed by one varint per channel per record,
+// each holding the zigzag encoded difference from the previous record's value.
+// The header names its channels, so readers skip channels they don't know and
+// leave channels missing from older traces at their defaults. A file cut short
+// by a crash reads back up to the last complete record.
+//
+//   "ASTRACE\0" | u32 version | u32 channel count | per channel: u8 length, name bytes | records...
+class TraceEncoder {
+public:
+    TraceEncoder();
+
+    // The header, written once at the start of the file
+    static std::vector<std::uint8_t> header();
+
+    void encode(const TraceRecord& record, std::vector<std::uint8_t>& out);
+
+private:
+    std::vector<std::int64_t> m_previous{};
+};
+
+class TraceDecoder {
+public:
+    // data must stay alive for as long as the decoder is used, it is read in place
+    TraceDecoder(const std::uint8_t* data, size_t size);
+
+    bool valid() const { return m_valid; }
+
+    // false at the end of the data or at a truncated record
+    bool next(TraceRecord& record);
+
+private:
+    bool read_varint(std::uint64_t& value);
+
+    const std::uint8_t* m_data;
+    const std::uint8_t* m_end;
+    bool m_valid{ false };
+    std::vector<int> m_channel_map{}; // file channel -> our channel, -1 if unknown
+    std::vector<std::uint64_t> m_raw{};
+    std::vector<std::int64_t> m_values{};
+};
+
+// Read-only memory mapping of a whole file
+class MappedFile {
+public:
+    MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const { return m_opened; }
+    const std::uint8_t* data() const { return m_data; }
+    size_t size() const { return m_size; }
+
+private:
+    const std::uint8_t* m_data{ nullptr };
+    size_t m_size{ 0 };
+    bool m_opened{ false };
+#ifdef _WIN32
+    void* m_file{ nullptr };
+    void* m_mapping{ nullptr };
+#endif
+};
+
+// Convenience for tools and tests, decodes a whole trace file
+bool read_trace(const std::filesystem::path& path, std::vector<TraceRecord>& records);
+}
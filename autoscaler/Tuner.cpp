@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+
+#include "Random.hpp"
+#include "Tuner.hpp"
+
+namespace autoscaler {
+const std::vector<TunedParameter>& tuned_parameters() {
+    static const std::vector<TunedParameter> s_parameters{
+        { "usagelowerbound", &Settings::usagelowerbound, 50, 95 },
+        { "usageupperbound", &Settings::usageupperbound, 60, 99 },
+        { "decreaseresamount", &Settings::decreaseresamount, 1, 10 },
+        { "increaseresamount", &Settings::increaseresamount, 1, 10 },
+        { "decreaseframesrequired", &Settings::decreaseframesrequired, 1, 60 },
+        { "increaseframesrequired", &Settings::increaseframesrequired, 1, 120 },
+    };
+
+    return s_parameters;
+}
+
+void constrain(Settings& settings) {
+    for (const auto& parameter : tuned_parameters()) {
+        settings.*parameter.value = std::clamp(settings.*parameter.value, parameter.min, parameter.max);
+    }
+
+    settings.usageupperbound = std::max(settings.usageupperbound, std::min(settings.usagelowerbound + 2, 99));
+    settings.usagelowerbound = std::min(settings.usagelowerbound, settings.usageupperbound - 2);
+}
+
+double score(const Scorecard& card, const Objective& objective) {
+    return objective.megapixel_weight * card.megapixels - objective.missed_weight * card.over_budget_share * 100.0;
+}
+
+void TuningCorpus::add_scenario(const Scenario& scenario, int seeds) {
+    const auto& stored = m_scenarios.emplace_back(scenario);
+
+    for (int seed = 1; seed <= seeds; ++seed) {
+        m_runs.push_back({ &stored, static_cast<std::uint64_t>(seed) });
+    }
+}
+
+void TuningCorpus::add_trace(std::vector<std::uint8_t> data) {
+    m_traces.push_back(std::move(data));
+}
+
+Scorecard TuningCorpus::run(size_t job, const Settings& settings) const {
+    if (job < m_runs.size()) {
+        return run_scenario(*m_runs[job].scenario, settings, m_runs[job].seed);
+    }
+
+    const auto& trace = m_traces[job - m_runs.size()];
+    const auto blocks = score_trace(trace.data(), trace.size(), settings, std::numeric_limits<double>::infinity());
+
+    return blocks.empty() ? Scorecard{} : blocks.front();
+}
+
+namespace {
+using Key = std::vector<int>;
+
+Key key_of(const Settings& settings) {
+    Key key{};
+
+    for (const auto& parameter : tuned_parameters()) {
+        key.push_back(settings.*parameter.value);
+    }
+
+    return key;
+}
+
+class Search {
+public:
+    Search(const TuningCorpus& corpus, const TunerOptions& options, WorkPool& pool,
+        const std::function<void(int, const Candidate&)>& on_batch)
+        : m_corpus{ corpus },
+        m_options{ options },
+        m_pool{ pool },
+        m_on_batch{ on_batch },
+        m_random{ options.seed }
+    {
+    }
+
+    // Scores every candidate not seen before, all of them in one parallel batch
+    std::vector<Candidate> evaluate(const std::vector<Settings>& batch) {
+        std::vector<Settings> fresh{};
+
+        for (const auto& settings : batch) {
+            const auto key = key_of(settings);
+
+            if (!m_scores.contains(key) && std::none_of(fresh.begin(), fresh.end(), [&](const Settings& s) { return key_of(s) == key; })) {
+                fresh.push_back(settings);
+            }
+        }
+
+        const auto jobs = m_corpus.jobs();
+        std::vector<double> scores(fresh.size() * jobs);
+
+        m_pool.parallel_for(scores.size(), [&](size_t i) {
+            scores[i] = score(m_corpus.run(i % jobs, fresh[i / jobs]), m_options.objective);
+        });
+
+        for (size_t c = 0; c < fresh.size(); ++c) {
+            double sum = 0.0;
+
+            for (size_t j = 0; j < jobs; ++j) {
+                sum += scores[c * jobs + j];
+            }
+
+            const Candidate candidate{ fresh[c], jobs > 0 ? sum / jobs : 0.0 };
+            m_scores.emplace(key_of(candidate.settings), candidate.score);
+            ++m_evaluations;
+
+            if (m_evaluations == 1 || candidate.score > m_best.score) {
+                m_best = candidate;
+            }
+        }
+
+        if (!fresh.empty() && m_on_batch) {
+            m_on_batch(m_evaluations, m_best);
+        }
+
+        std::vector<Candidate> result{};
+
+        for (const auto& settings : batch) {
+            result.push_back({ settings, m_scores.at(key_of(settings)) });
+        }
+
+        return result;
+    }
+
+    Settings random_settings(Settings settings) {
+        for (const auto& parameter : tuned_parameters()) {
+            settings.*parameter.value = parameter.min + static_cast<int>(m_random.below(parameter.max - parameter.min + 1));
+        }
+
+        constrain(settings);
+        return settings;
+    }
+
+    // Moves roughly one parameter by a tenth of its range, always by at least one step
+    Settings mutate(Settings settings) {
+        const auto& parameters = tuned_parameters();
+        const auto forced = m_random.below(parameters.size());
+
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            if (i != forced && m_random.below(parameters.size()) != 0) {
+                continue;
+            }
+
+            const auto& parameter = parameters[i];
+            auto step = static_cast<int>(std::lround(m_random.gaussian() * (parameter.max - parameter.min) * 0.1));
+
+            if (step == 0) {
+                step = m_random.below(2) == 0 ? -1 : 1;
+            }
+
+            settings.*parameter.value += step;
+        }
+
+        constrain(settings);
+        return settings;
+    }
+
+    Settings crossover(const Settings& a, const Settings& b) {
+        auto child = a;
+
+        for (const auto& parameter : tuned_parameters()) {
+            if (m_random.below(2) == 0) {
+                child.*parameter.value = b.*parameter.value;
+            }
+        }
+
+        constrain(child);
+        return child;
+    }
+
+    const Candidate& tournament(const std::vector<Candidate>& population) {
+        const auto& a = population[m_random.below(population.size())];
+        const auto& b = population[m_random.below(population.size())];
+        return a.score >= b.score ? a : b;
+    }
+
+    bool seen(const Settings& settings) const { return m_scores.contains(key_of(settings)); }
+    int evaluations() const { return m_evaluations; }
+    const Candidate& best() const { return m_best; }
+
+private:
+    const TuningCorpus& m_corpus;
+    const TunerOptions& m_options;
+    WorkPool& m_pool;
+    const std::function<void(int, const Candidate&)>& m_on_batch;
+    Random m_random;
+    std::map<Key, double> m_scores{};
+    int m_evaluations{ 0 };
+    Candidate m_best{};
+};
+
+void grid_search(Search& search, const Settings& start, const TunerOptions& options) {
+    const auto& parameters = tuned_parameters();
+    const auto points = std::max(2, options.grid_points);
+
+    std::vector<Settings> batch{};
+    std::vector<int> index(parameters.size(), 0);
+
+    while (true) {
+        auto settings = start;
+
+        for (size_t i = 0; i < parameters.size(); ++i) {
+            const auto& parameter = parameters[i];
+            settings.*parameter.value = parameter.min + static_cast<int>(std::lround(
+                static_cast<double>(parameter.max - parameter.min) * index[i] / (points - 1)));
+        }
+
+        constrain(settings);
+        batch.push_back(settings);
+
+        // odometer over every combination
+        size_t i = 0;
+        while (i < index.size() && ++index[i] == points) {
+            index[i++] = 0;
+        }
+
+        if (i == index.size()) {
+            break;
+        }
+    }
+
+    search.evaluate(batch);
+}
+
+void random_search(Search& search, const Settings& start, const TunerOptions& options) {
+    const auto batch_size = static_cast<size_t>(std::max(1, options.population));
+
+    while (search.evaluations() < options.budget) {
+        std::vector<Settings> batch{};
+
+        for (size_t i = 0; i < batch_size && search.evaluations() + static_cast<int>(batch.size()) < options.budget; ++i) {
+            batch.push_back(search.random_settings(start));
+        }
+
+        search.evaluate(batch);
+    }
+}
+
+// (mu + lambda): the best of parents and children survive, children come from tournament
+// selection, uniform crossover and mutation
+void evolutionary_search(Search& search, const Settings& start, const TunerOptions& options) {
+    const auto size = static_cast<size_t>(std::max(4, options.population));
+
+    std::vector<Settings> initial{ start };
+    while (initial.size() < size) {
+        initial.push_back(search.random_settings(start));
+    }
+
+    auto population = search.evaluate(initial);
+
+    while (search.evaluations() < options.budget) {
+        std::vector<Settings> children{};
+
+        // a converged population keeps producing known candidates, don't spin on them forever
+        for (size_t attempts = 0; children.size() < size && attempts < size * 20; ++attempts) {
+            auto child = search.mutate(search.crossover(search.tournament(population).settings, search.tournament(population).settings));
+
+            if (!search.seen(child)) {
+                children.push_back(child);
+            }
+        }
+
+        if (children.empty()) {
+            break;
+        }
+
+        const auto scored = search.evaluate(children);
+        population.insert(population.end(), scored.begin(), scored.end());
+
+        std::stable_sort(population.begin(), population.end(), [](const Candidate& a, const Candidate& b) { return a.score > b.score; });
+        population.resize(std::min(population.size(), size));
+    }
+}
+}
+
+TuneResult tune(const TuningCorpus& corpus, const Settings& start, const TunerOptions& options, WorkPool& pool,
+    const std::function<void(int evaluations, const Candidate& best)>& on_batch)
+{
+    auto constrained = start;
+    constrain(constrained);
+
+    Search search{ corpus, options, pool, on_batch };
+
+    TuneResult result{};
+    result.start = search.evaluate({ constrained }).front();
+
+    switch (options.strategy) {
+    case SearchStrategy::Grid:
+        grid_search(search, constrained, options);
+        break;
+    case SearchStrategy::Random:
+        random_search(search, constrained, options);
+        break;
+    case SearchStrategy::Evolutionary:
+        evolutionary_search(search, constrained, options);
+        break;
+    }
+
+    result.best = search.best();
+    result.evaluations = search.evaluations();
+    return result;
+}
+}
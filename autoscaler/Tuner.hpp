@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Benchmark.hpp"
+#include "WorkPool.hpp"
+
+namespace autoscaler {
+// A setting the tuner is allowed to change, and the range it searches
+struct TunedParameter {
+    const char* name;
+    int Settings::*value;
+    int min;
+    int max;
+};
+
+// The band, the frame thresholds and the step sizes
+const std::vector<TunedParameter>& tuned_parameters();
+
+// Clamps every tuned parameter into its range and keeps the band at least 2 points wide
+void constrain(Settings& settings);
+
+// Higher is better: delivered resolution against missed frames
+struct Objective {
+    double megapixel_weight{ 1.0 };  // per average rendered megapixel
+    double missed_weight{ 1.0 };     // per percent of frames over budget
+};
+
+double score(const Scorecard& card, const Objective& objective);
+
+// What settings are scored on: simulator scenarios, each over a number of seeds, and recorded traces
+class TuningCorpus {
+public:
+    void add_scenario(const Scenario& scenario, int seeds);
+    void add_trace(std::vector<std::uint8_t> data);
+
+    // Independent units of work, one per scenario seed or trace
+    size_t jobs() const { return m_runs.size() + m_traces.size(); }
+    Scorecard run(size_t job, const Settings& settings) const;
+
+private:
+    struct ScenarioRun {
+        const Scenario* scenario;
+        std::uint64_t seed;
+    };
+
+    std::deque<Scenario> m_scenarios{}; // stable addresses for m_runs
+    std::vector<ScenarioRun> m_runs{};
+    std::vector<std::vector<std::uint8_t>> m_traces{};
+};
+
+enum class SearchStrategy {
+    Grid,
+    Random,
+    Evolutionary
+};
+
+struct TunerOptions {
+    SearchStrategy strategy{ SearchStrategy::Evolutionary };
+    int budget{ 400 };          // candidate evaluations, the grid ignores it
+    int grid_points{ 3 };       // per parameter
+    int population{ 32 };
+    std::uint64_t seed{ 1 };
+    Objective objective{};
+};
+
+struct Candidate {
+    Settings settings{};
+    double score{ 0.0 };
+};
+
+struct TuneResult {
+    Candidate best{};
+    Candidate start{};
+    int evaluations{ 0 };
+};
+
+// Searches the tuned parameters around start. Every batch of candidates is spread over the
+// pool one (candidate, job) pair at a time. Deterministic for a seed whatever the pool size.
+// on_batch, if set, is called after each batch with the best candidate so far.
+TuneResult tune(const TuningCorpus& corpus, const Settings& start, const TunerOptions& options, WorkPool& pool,
+    const std::function<void(int evaluations, const Candidate& best)>& on_batch = {});
+}
@@ -0,0 +1,113 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Vsync.hpp"
+
+namespace autoscaler {
+namespace {
+// 256 bins cover deltas up to 64 ms, a 15 Hz refresh
+constexpr double BIN_MS = 0.25;
+// Jitter around a refresh stays within about half a millisecond
+constexpr int TOLERANCE_BINS = 2;
+// Frames that have to be seen before the interval is trusted, and how many the histogram holds before halving
+constexpr float MIN_FRAMES = 90.0f;
+constexpr float HISTORY_FRAMES = 1024.0f;
+constexpr int ESTIMATE_EVERY = 32;
+// A peak needs this share of frames to be the refresh rather than a few odd deltas
+constexpr float MIN_PEAK_SHARE = 0.1f;
+// Share of frames on multiples of the interval for the deltas to count as quantized
+constexpr float QUANTIZED_SHARE = 0.8f;
+}
+
+int VsyncDetector::add(float delta) {
+    const auto frame_ms = delta * 1000.0;
+
+    if (frame_ms <= 0.0) {
+        return 0;
+    }
+
+    const auto bin = static_cast<int>(frame_ms / BIN_MS);
+
+    if (bin < BINS) {
+        m_bins[bin] += 1.0f;
+        m_total += 1.0f;
+    }
+
+    if (m_total >= HISTORY_FRAMES) {
+        for (auto& count : m_bins) {
+            count *= 0.5f;
+        }
+
+        m_total *= 0.5f;
+    }
+
+    if (++m_since_estimate >= ESTIMATE_EVERY) {
+        estimate();
+        m_since_estimate = 0;
+    }
+
+    const auto missed = m_quantized ? std::max(static_cast<int>(std::lround(frame_ms / m_interval_ms)) - 1, 0) : 0;
+    m_missed.push(delta, static_cast<float>(missed));
+    return missed;
+}
+
+void VsyncDetector::clear() {
+    m_bins.fill(0.0f);
+    m_total = 0.0f;
+    m_since_estimate = 0;
+    m_interval_ms = 0.0;
+    m_quantized = false;
+    m_missed.clear();
+}
+
+int VsyncDetector::missed(float span) const {
+    return static_cast<int>(m_missed.sum(span) + 0.5f);
+}
+
+void VsyncDetector::estimate() {
+    if (m_total < MIN_FRAMES) {
+        return;
+    }
+
+    const auto cluster = [this](int center, double& weighted) {
+        auto count = 0.0f;
+
+        for (int i = std::max(center - TOLERANCE_BINS, 0); i <= std::min(center + TOLERANCE_BINS, BINS - 1); ++i) {
+            count += m_bins[i];
+            weighted += m_bins[i] * (i + 0.5) * BIN_MS;
+        }
+
+        return count;
+    };
+
+    // The refresh is the shortest delta frames bunch up at, the longer peaks are its multiples
+    for (int i = 0; i < BINS; ++i) {
+        const auto peak = m_bins[i] > 0.0f && (i == 0 || m_bins[i] >= m_bins[i - 1]) && (i == BINS - 1 || m_bins[i] >= m_bins[i + 1]);
+
+        if (!peak) {
+            continue;
+        }
+
+        auto weighted = 0.0;
+        const auto count = cluster(i, weighted);
+
+        if (count < MIN_PEAK_SHARE * m_total) {
+            continue;
+        }
+
+        m_interval_ms = weighted / count;
+
+        auto on_multiples = 0.0f;
+
+        for (int multiple = 1; multiple * m_interval_ms < BINS * BIN_MS; ++multiple) {
+            auto ignored = 0.0;
+            on_multiples += cluster(static_cast<int>(multiple * m_interval_ms / BIN_MS), ignored);
+        }
+
+        m_quantized = on_multiples >= QUANTIZED_SHARE * m_total;
+        return;
+    }
+
+    m_quantized = false;
+}
+}
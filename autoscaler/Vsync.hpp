@@ -0,0 +1,37 @@
+#pragma once
+
+#include <array>
+
+#include "TimeWindow.hpp"
+
+namespace autoscaler {
+// Works out the refresh interval from engine deltas alone. With vsync, as in VR, a frame that misses the
+// refresh waits for the next one, so deltas bunch up at whole multiples of the interval and each says how
+// many refreshes the frame missed. Needs no driver API, so it works the same on any GPU vendor.
+class VsyncDetector {
+public:
+    // Returns the refresh intervals this frame missed, 0 until the interval is known
+    int add(float delta);
+
+    void clear();
+
+    // The shortest interval deltas bunch up at, 0 until enough frames have been seen
+    double interval_ms() const { return m_interval_ms; }
+    // Most deltas sit on a multiple of the interval. Without vsync they spread out and none count as missed.
+    bool quantized() const { return m_quantized; }
+    // Missed intervals over the newest span seconds, which can't reach back further than about a second
+    int missed(float span) const;
+
+private:
+    static constexpr int BINS = 256;
+
+    void estimate();
+
+    std::array<float, BINS> m_bins{}; // histogram of deltas, halved now and then so old frames fade out
+    float m_total{ 0.0f };
+    int m_since_estimate{ 0 };
+    double m_interval_ms{ 0.0 };
+    bool m_quantized{ false };
+    TimeWindow<1024> m_missed{ 1.0f };
+};
+}
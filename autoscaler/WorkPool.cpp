@@ -0,0 +1,128 @@
+#include <algorithm>
+
+#include "WorkPool.hpp"
+
+namespace autoscaler {
+WorkPool::WorkPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    // queue 0 belongs to the thread calling parallel_for
+    for (unsigned i = 1; i < threads; ++i) {
+        m_threads.emplace_back([this, i] { run(i); });
+    }
+}
+
+WorkPool::~WorkPool() {
+    {
+        std::scoped_lock _{ m_mutex };
+        m_stopping = true;
+    }
+
+    m_start_cv.notify_all();
+
+    for (auto& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void WorkPool::parallel_for(size_t count, const std::function<void(size_t)>& job) {
+    if (count == 0) {
+        return;
+    }
+
+    // set before any job is visible, a worker still draining the last batch may pick one up early
+    {
+        std::scoped_lock _{ m_mutex };
+        m_job = &job;
+        m_remaining = count;
+    }
+
+    // contiguous slices, so a worker's own jobs and the ones stolen from it don't interleave
+    const auto workers = m_queues.size();
+
+    for (size_t w = 0; w < workers; ++w) {
+        std::scoped_lock _{ m_queues[w]->mutex };
+
+        for (auto i = count * w / workers; i < count * (w + 1) / workers; ++i) {
+            m_queues[w]->items.push_back(i);
+        }
+    }
+
+    {
+        std::scoped_lock _{ m_mutex };
+        ++m_batch;
+    }
+
+    m_start_cv.notify_all();
+
+    work(0);
+
+    std::unique_lock lock{ m_mutex };
+    m_done_cv.wait(lock, [this] { return m_remaining == 0; });
+    m_job = nullptr;
+}
+
+void WorkPool::run(size_t worker) {
+    std::uint64_t seen = 0;
+    std::unique_lock lock{ m_mutex };
+
+    while (true) {
+        m_start_cv.wait(lock, [&] { return m_stopping || m_batch != seen; });
+
+        if (m_stopping) {
+            return;
+        }
+
+        seen = m_batch;
+
+        lock.unlock();
+        work(worker);
+        lock.lock();
+    }
+}
+
+void WorkPool::work(size_t worker) {
+    size_t index = 0;
+
+    while (take(worker, index)) {
+        (*m_job)(index);
+
+        if (m_remaining.fetch_sub(1) == 1) {
+            std::scoped_lock _{ m_mutex };
+            m_done_cv.notify_all();
+        }
+    }
+}
+
+bool WorkPool::take(size_t worker, size_t& index) {
+    {
+        auto& own = *m_queues[worker];
+        std::scoped_lock _{ own.mutex };
+
+        if (!own.items.empty()) {
+            index = own.items.back();
+            own.items.pop_back();
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < m_queues.size(); ++i) {
+        auto& victim = *m_queues[(worker + i) % m_queues.size()];
+        std::scoped_lock _{ victim.mutex };
+
+        if (!victim.items.empty()) {
+            index = victim.items.front();
+            victim.items.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace autoscaler {
+// A fixed set of worker threads for batches of independent jobs.
+//
+// Each worker has its own queue and is handed a contiguous slice of every batch. It works
+// from the back of its own queue and, once that runs dry, steals from the front of the
+// others, so uneven jobs (a long trace next to a short scenario) still keep every core busy.
+// The calling thread works on the batch too.
+class WorkPool {
+public:
+    // 0 uses every hardware thread
+    explicit WorkPool(unsigned threads = 0);
+    ~WorkPool();
+
+    WorkPool(const WorkPool&) = delete;
+    WorkPool& operator=(const WorkPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(m_queues.size()); }
+
+    // Runs job(i) for every i in [0, count) and returns once all of them have finished.
+    // One batch at a time, jobs must not throw.
+    void parallel_for(size_t count, const std::function<void(size_t)>& job);
+
+private:
+    struct Queue {
+        std::mutex mutex{};
+        std::deque<size_t> items{};
+    };
+
+    void run(size_t worker);
+    void work(size_t worker);
+    bool take(size_t worker, size_t& index);
+
+    std::vector<std::unique_ptr<Queue>> m_queues{};
+    const std::function<void(size_t)>* m_job{ nullptr };
+    std::atomic<size_t> m_remaining{ 0 };
+
+    std::mutex m_mutex{};
+    std::condition_variable m_start_cv{};
+    std::condition_variable m_done_cv{};
+    std::uint64_t m_batch{ 0 };
+    bool m_stopping{ false };
+    std::vector<std::thread> m_threads{};
+};
+}
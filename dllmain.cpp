@@ -24,10 +24,23 @@ SOFTWARE.
 #include <sstream>
 #include <mutex>
 #include <memory>
+#include <atomic>
+#include <array>
+#include <vector>
+#include <cstring>
+#include <thread>
+#include <condition_variable>
+#include <unordered_map>
+#include <optional>
+#include <algorithm>
 #include <locale>
 #include <codecvt>
 
 #include <Windows.h>
+#include <d3d11.h>
+#include <d3d12.h>
+#include <dxgi1_4.h>
+#include <wrl/client.h>
 #include <filesystem>
 
 // only really necessary if you want to render to the screen
@@ -40,11 +53,17 @@ SOFTWARE.
 
 #include "uevr/Plugin.hpp"
 
-#include <C:\Program Files\NVIDIA GPU Computing Toolkit\CUDA\v12.9\include\nvml.h>
+#include <nvml.h>
 #include "json.hpp"
 #include <fstream>
 #include <chrono>
 
+#include "autoscaler/AutoTune.hpp"
+#include "autoscaler/Calibration.hpp"
+#include "autoscaler/FramePacing.hpp"
+#include "autoscaler/Pipeline.hpp"
+#include "autoscaler/TelemetryRecorder.hpp"
+
 using namespace uevr;
 
 #define PLUGIN_LOG_ONCE(...) \
@@ -54,6 +73,496 @@ using namespace uevr;
         API::get()->log_info(__VA_ARGS__); \
     }
 
+// A deep copy of one frame's ImDrawData. Storage is reused between frames so
+// steady-state copies don't allocate once the buffers have grown.
+struct DrawDataSnapshot {
+    ImDrawData draw_data{};
+    ImVector<ImDrawList*> lists{};
+    uint32_t generation{ 0 };
+
+    ~DrawDataSnapshot() {
+        for (auto list : lists) {
+            IM_DELETE(list);
+        }
+    }
+
+    void assign(const ImDrawData* src, uint32_t gen) {
+        generation = gen;
+
+        if (src == nullptr || !src->Valid) {
+            draw_data.Valid = false;
+            return;
+        }
+
+        while (lists.Size < src->CmdListsCount) {
+            lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+
+        draw_data.CmdLists.resize(src->CmdListsCount);
+
+        for (int i = 0; i < src->CmdListsCount; ++i) {
+            const auto from = src->CmdLists[i];
+            auto to = lists[i];
+
+            copy_vector(to->CmdBuffer, from->CmdBuffer);
+            copy_vector(to->IdxBuffer, from->IdxBuffer);
+            copy_vector(to->VtxBuffer, from->VtxBuffer);
+            to->Flags = from->Flags;
+
+            draw_data.CmdLists[i] = to;
+        }
+
+        draw_data.CmdListsCount = src->CmdListsCount;
+        draw_data.TotalIdxCount = src->TotalIdxCount;
+        draw_data.TotalVtxCount = src->TotalVtxCount;
+        draw_data.DisplayPos = src->DisplayPos;
+        draw_data.DisplaySize = src->DisplaySize;
+        draw_data.FramebufferScale = src->FramebufferScale;
+        draw_data.Valid = true;
+    }
+
+private:
+    // ImVector::operator= frees and reallocates, resize keeps the capacity
+    template <typename T>
+    static void copy_vector(ImVector<T>& to, const ImVector<T>& from) {
+        to.resize(from.Size);
+
+        if (from.Size > 0) {
+            std::memcpy(to.Data, from.Data, from.size_in_bytes());
+        }
+    }
+};
+
+// Lock-free triple buffer between the game thread (producer) and the render thread (consumer).
+// The producer always has a free slot to write into and the consumer only ever sees the
+// latest fully written snapshot, so neither side waits on the other.
+class DrawDataTripleBuffer {
+public:
+    // Game thread only
+    DrawDataSnapshot& back() {
+        return m_slots[m_back];
+    }
+
+    // Game thread only
+    void publish() {
+        m_back = m_ready.exchange(m_back | NEW_DATA, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Render thread only. Returns the newest published snapshot, or the last one again if nothing new arrived.
+    DrawDataSnapshot& acquire() {
+        if ((m_ready.load(std::memory_order_relaxed) & NEW_DATA) != 0) {
+            m_front = m_ready.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        }
+
+        return m_slots[m_front];
+    }
+
+private:
+    static constexpr int INDEX_MASK = 0x3;
+    static constexpr int NEW_DATA = 0x4;
+
+    std::array<DrawDataSnapshot, 3> m_slots{};
+    int m_back{ 0 };
+    int m_front{ 1 };
+    std::atomic<int> m_ready{ 2 };
+};
+
+// The helpers in rendering/ take no draw data, they draw ImGui::GetDrawData(), which is the frame the game
+// thread is building. These two draw a snapshot onto the flat screen's back buffer the way their
+// render_imgui() does, with device objects of their own. Render thread only.
+class D3D11DesktopOverlay {
+public:
+    void render(ImDrawData* draw_data, ID3D11Device* device, IDXGISwapChain* swapchain) {
+        if (m_back_buffer_rtv == nullptr) {
+            Microsoft::WRL::ComPtr<ID3D11Texture2D> back_buffer{};
+
+            if (FAILED(swapchain->GetBuffer(0, IID_PPV_ARGS(&back_buffer)))
+                || FAILED(device->CreateRenderTargetView(back_buffer.Get(), nullptr, &m_back_buffer_rtv))) {
+                return;
+            }
+        }
+
+        Microsoft::WRL::ComPtr<ID3D11DeviceContext> context{};
+        device->GetImmediateContext(&context);
+        context->OMSetRenderTargets(1, m_back_buffer_rtv.GetAddressOf(), nullptr);
+        ImGui_ImplDX11_RenderDrawData(draw_data);
+    }
+
+    // Before the swapchain's buffers are resized or released
+    void reset() {
+        m_back_buffer_rtv.Reset();
+    }
+
+private:
+    Microsoft::WRL::ComPtr<ID3D11RenderTargetView> m_back_buffer_rtv{};
+};
+
+class D3D12DesktopOverlay {
+public:
+    ~D3D12DesktopOverlay() {
+        reset();
+    }
+
+    // srv_heap holds the font texture, it's the heap the ImGui backend was set up with
+    void render(ImDrawData* draw_data, ID3D12Device* device, ID3D12CommandQueue* command_queue, IDXGISwapChain3* swapchain,
+        ID3D12DescriptorHeap* srv_heap)
+    {
+        if (m_fence == nullptr && !create(device, swapchain)) {
+            return;
+        }
+
+        const auto index = swapchain->GetCurrentBackBufferIndex();
+
+        if (index >= m_frames.size()) {
+            return;
+        }
+
+        auto& frame = m_frames[index];
+
+        // The list recorded the last time this back buffer came round has to be done with
+        wait(frame.fence_value);
+
+        frame.allocator->Reset();
+        frame.command_list->Reset(frame.allocator.Get(), nullptr);
+
+        D3D12_RESOURCE_BARRIER barrier{};
+        barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+        barrier.Transition.pResource = frame.back_buffer.Get();
+        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+        barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
+        barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
+        frame.command_list->ResourceBarrier(1, &barrier);
+
+        ID3D12DescriptorHeap* heaps[]{ srv_heap };
+        frame.command_list->OMSetRenderTargets(1, &frame.rtv, FALSE, nullptr);
+        frame.command_list->SetDescriptorHeaps(1, heaps);
+        ImGui_ImplDX12_RenderDrawData(draw_data, frame.command_list.Get());
+
+        std::swap(barrier.Transition.StateBefore, barrier.Transition.StateAfter);
+        frame.command_list->ResourceBarrier(1, &barrier);
+        frame.command_list->Close();
+
+        ID3D12CommandList* command_lists[]{ frame.command_list.Get() };
+        command_queue->ExecuteCommandLists(1, command_lists);
+        command_queue->Signal(m_fence.Get(), ++m_fence_value);
+        frame.fence_value = m_fence_value;
+    }
+
+    // Before the swapchain's buffers are resized or released. Waits for the GPU to be done with them.
+    void reset() {
+        wait(m_fence_value);
+
+        m_frames.clear();
+        m_rtv_heap.Reset();
+        m_fence.Reset();
+        m_fence_value = 0;
+
+        if (m_event != nullptr) {
+            CloseHandle(m_event);
+            m_event = nullptr;
+        }
+    }
+
+private:
+    struct Frame {
+        Microsoft::WRL::ComPtr<ID3D12Resource> back_buffer{};
+        Microsoft::WRL::ComPtr<ID3D12CommandAllocator> allocator{};
+        Microsoft::WRL::ComPtr<ID3D12GraphicsCommandList> command_list{};
+        D3D12_CPU_DESCRIPTOR_HANDLE rtv{};
+        UINT64 fence_value{ 0 };
+    };
+
+    bool create(ID3D12Device* device, IDXGISwapChain3* swapchain) {
+        DXGI_SWAP_CHAIN_DESC swap_desc{};
+
+        if (FAILED(swapchain->GetDesc(&swap_desc))) {
+            return false;
+        }
+
+        D3D12_DESCRIPTOR_HEAP_DESC heap_desc{};
+        heap_desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+        heap_desc.NumDescriptors = swap_desc.BufferCount;
+
+        if (FAILED(device->CreateDescriptorHeap(&heap_desc, IID_PPV_ARGS(&m_rtv_heap)))) {
+            return false;
+        }
+
+        const auto rtv_size = device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+        auto rtv = m_rtv_heap->GetCPUDescriptorHandleForHeapStart();
+        m_frames.resize(swap_desc.BufferCount);
+
+        for (UINT i = 0; i < swap_desc.BufferCount; ++i) {
+            auto& frame = m_frames[i];
+
+            if (FAILED(swapchain->GetBuffer(i, IID_PPV_ARGS(&frame.back_buffer)))
+                || FAILED(device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&frame.allocator)))
+                || FAILED(device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, frame.allocator.Get(), nullptr, IID_PPV_ARGS(&frame.command_list)))) {
+                reset();
+                return false;
+            }
+
+            frame.command_list->Close();
+            frame.rtv = rtv;
+            device->CreateRenderTargetView(frame.back_buffer.Get(), nullptr, rtv);
+            rtv.ptr += rtv_size;
+        }
+
+        m_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+
+        if (m_event == nullptr || FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)))) {
+            reset();
+            return false;
+        }
+
+        return true;
+    }
+
+    void wait(UINT64 value) {
+        if (m_fence == nullptr || m_fence->GetCompletedValue() >= value) {
+            return;
+        }
+
+        m_fence->SetEventOnCompletion(value, m_event);
+        WaitForSingleObject(m_event, INFINITE);
+    }
+
+    std::vector<Frame> m_frames{};
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_rtv_heap{};
+    Microsoft::WRL::ComPtr<ID3D12Fence> m_fence{};
+    UINT64 m_fence_value{ 0 };
+    HANDLE m_event{ nullptr };
+};
+
+// Writes files from a background thread once they have stopped changing for a while.
+// Repeated writes to the same path inside the quiet period collapse into one, and each
+// write goes to a temp file first which is then renamed over the target.
+class DebouncedFileWriter {
+public:
+    DebouncedFileWriter(std::chrono::milliseconds quiet_period)
+        : m_quiet_period{ quiet_period },
+        m_thread{ [this] { run(); } }
+    {
+    }
+
+    ~DebouncedFileWriter() {
+        {
+            std::scoped_lock _{ m_mutex };
+            m_stopping = true;
+        }
+
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    // Cheap enough to call from the game thread, only copies the contents into the queue
+    void write(const std::filesystem::path& path, std::string contents) {
+        {
+            std::scoped_lock _{ m_mutex };
+            m_pending[path.wstring()] = std::move(contents);
+            m_last_write = std::chrono::steady_clock::now();
+        }
+
+        m_cv.notify_one();
+    }
+
+private:
+    void run() {
+        std::unique_lock lock{ m_mutex };
+
+        while (true) {
+            m_cv.wait(lock, [this] { return m_stopping || !m_pending.empty(); });
+
+            // Wait for the quiet period, restarting it whenever another write comes in
+            while (!m_stopping && std::chrono::steady_clock::now() - m_last_write < m_quiet_period) {
+                m_cv.wait_until(lock, m_last_write + m_quiet_period);
+            }
+
+            auto pending = std::move(m_pending);
+            m_pending.clear();
+
+            lock.unlock();
+
+            for (const auto& [path, contents] : pending) {
+                write_file(path, contents);
+            }
+
+            lock.lock();
+
+            if (m_stopping && m_pending.empty()) {
+                return;
+            }
+        }
+    }
+
+    static void write_file(const std::filesystem::path& path, const std::string& contents) {
+        auto temp_path = path;
+        temp_path += L".tmp";
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                API::get()->log_error("Failed to open %s for writing", temp_path.string().c_str());
+                return;
+            }
+
+            file << contents;
+
+            if (!file.good()) {
+                API::get()->log_error("Failed to write %s", temp_path.string().c_str());
+                return;
+            }
+        }
+
+        std::error_code ec{};
+        std::filesystem::rename(temp_path, path, ec);
+
+        if (ec) {
+            API::get()->log_error("Failed to replace %s: %s", path.string().c_str(), ec.message().c_str());
+        }
+    }
+
+    std::chrono::milliseconds m_quiet_period;
+    std::mutex m_mutex{};
+    std::condition_variable m_cv{};
+    std::unordered_map<std::wstring, std::string> m_pending{};
+    std::chrono::steady_clock::time_point m_last_write{};
+    bool m_stopping{ false };
+    std::thread m_thread;
+};
+
+// Polls a JSON file's metadata on a background thread and parses it there when it changes.
+// The game thread picks the result up with take() at whatever point suits it.
+class ConfigWatcher {
+public:
+    ConfigWatcher(std::filesystem::path path, std::chrono::milliseconds interval)
+        : m_path{ std::move(path) },
+        m_interval{ interval },
+        m_last_stamp{ stamp() },
+        m_thread{ [this] { run(); } }
+    {
+    }
+
+    ~ConfigWatcher() {
+        {
+            std::scoped_lock _{ m_mutex };
+            m_stopping = true;
+        }
+
+        m_cv.notify_one();
+        m_thread.join();
+    }
+
+    // Game thread. Only takes the lock when something new has been parsed.
+    std::optional<nlohmann::json> take() {
+        if (!m_has_pending.load(std::memory_order_acquire)) {
+            return std::nullopt;
+        }
+
+        std::scoped_lock _{ m_mutex };
+        m_has_pending = false;
+        return std::move(m_pending);
+    }
+
+private:
+    struct Stamp {
+        std::filesystem::file_time_type time{};
+        std::uintmax_t size{ 0 };
+
+        bool operator==(const Stamp&) const = default;
+    };
+
+    Stamp stamp() const {
+        std::error_code ec{};
+        Stamp result{};
+        result.time = std::filesystem::last_write_time(m_path, ec);
+        result.size = ec ? 0 : std::filesystem::file_size(m_path, ec);
+        return result;
+    }
+
+    void run() {
+        std::unique_lock lock{ m_mutex };
+
+        while (!m_cv.wait_for(lock, m_interval, [this] { return m_stopping; })) {
+            lock.unlock();
+            poll();
+            lock.lock();
+        }
+    }
+
+    void poll() {
+        const auto current = stamp();
+
+        if (current == m_last_stamp) {
+            return;
+        }
+
+        m_last_stamp = current;
+
+        std::ifstream file(m_path);
+        if (!file.is_open()) {
+            return;
+        }
+
+        // Editors often save in several steps, a half written file is simply picked up on the next change
+        auto j = nlohmann::json::parse(file, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) {
+            API::get()->log_warn("Ignoring unreadable config %s", m_path.string().c_str());
+            return;
+        }
+
+        std::scoped_lock _{ m_mutex };
+        m_pending = std::move(j);
+        m_has_pending = true;
+    }
+
+    std::filesystem::path m_path;
+    std::chrono::milliseconds m_interval;
+    Stamp m_last_stamp{};
+    std::mutex m_mutex{};
+    std::condition_variable m_cv{};
+    std::optional<nlohmann::json> m_pending{};
+    std::atomic<bool> m_has_pending{ false };
+    bool m_stopping{ false };
+    std::thread m_thread;
+};
+
+// GPU usage from the NVIDIA Management Library, first device only
+class NvmlSensor : public autoscaler::Sensor {
+public:
+    int read_usage() override {
+        if (!m_initialized) {
+            API::get()->log_info("Init start");
+            if (nvmlInit() != NVML_SUCCESS)
+                return -1;
+            if (nvmlDeviceGetHandleByIndex(0, &m_device) != NVML_SUCCESS)
+                return -1;
+            m_initialized = true;
+            API::get()->log_info("Init done");
+        }
+
+        nvmlUtilization_t utilization;
+        if (nvmlDeviceGetUtilizationRates(m_device, &utilization) == NVML_SUCCESS) {
+            return utilization.gpu;
+        }
+
+        return -1;
+    }
+
+private:
+    bool m_initialized{ false };
+    nvmlDevice_t m_device{};
+};
+
+// Applies the screen percentage through the engine console every tick, in case the game resets it
+class ScreenPercentageActuator : public autoscaler::Actuator {
+public:
+    void apply(int screen_percentage) override {
+        std::wstring command = L"r.ScreenPercentage ";
+        command.append(std::to_wstring(screen_percentage));
+        API::get()->sdk()->functions->execute_command(command.c_str());
+    }
+};
+
 class ExamplePlugin : public uevr::Plugin {
 public:
     ExamplePlugin() = default;
@@ -62,12 +571,30 @@ public:
 
     void on_initialize() override {
         configpath = API::get()->get_persistent_dir(L"autoscalerconfig.json").string();
+        imguiinipath = API::get()->get_persistent_dir(L"imgui_example_plugin.ini").string();
+        // Shared by every game, so it lives in the UEVR global dir rather than the game's folder
+        profilespath = API::get()->get_persistent_dir().parent_path().append(L"autoscalerprofiles.json").string();
+        tracesdir = API::get()->get_persistent_dir(L"traces");
+        calibrationpath = API::get()->get_persistent_dir(L"autoscalercalibration.json").string();
         load_config();
+        load_profile();
+        update_recorder();
+        load_calibrations();
+        // Both, a profile only overrides what it sets and inherits the rest from the generic config
+        m_config_watcher = std::make_unique<ConfigWatcher>(configpath, std::chrono::milliseconds{ 500 });
+        m_profiles_watcher = std::make_unique<ConfigWatcher>(profilespath, std::chrono::milliseconds{ 500 });
         ImGui::CreateContext();
     }
 
     void on_present() override {
-        std::scoped_lock _{ m_imgui_mutex };
+        // The runtime's own frame timing, handed to the engine thread to analyze
+        const auto now = std::chrono::steady_clock::now();
+
+        if (m_last_present != std::chrono::steady_clock::time_point{}) {
+            m_presents.push(std::chrono::duration<float>(now - m_last_present).count());
+        }
+
+        m_last_present = now;
 
         if (!m_initialized) {
             if (!initialize_imgui()) {
@@ -83,26 +610,30 @@ public:
 
         if (!API::get()->param()->vr->is_hmd_active()) {
             if (!m_was_rendering_desktop) {
-                m_was_rendering_desktop = true;
-                on_device_reset();
+                m_was_rendering_desktop = try_reset_device();
                 return;
             }
 
-            m_was_rendering_desktop = true;
+            const auto draw_data = acquire_draw_data();
+
+            if (draw_data == nullptr) {
+                return;
+            }
 
             if (renderer_data->renderer_type == UEVR_RENDERER_D3D11) {
                 ImGui_ImplDX11_NewFrame();
-                g_d3d11.render_imgui();
+                m_d3d11_desktop.render(draw_data, (ID3D11Device*)renderer_data->device, (IDXGISwapChain*)renderer_data->swapchain);
             }
             else if (renderer_data->renderer_type == UEVR_RENDERER_D3D12) {
                 auto command_queue = (ID3D12CommandQueue*)renderer_data->command_queue;
+                Microsoft::WRL::ComPtr<IDXGISwapChain3> swapchain{};
 
-                if (command_queue == nullptr) {
+                if (command_queue == nullptr || FAILED(((IDXGISwapChain*)renderer_data->swapchain)->QueryInterface(IID_PPV_ARGS(&swapchain)))) {
                     return;
                 }
 
                 ImGui_ImplDX12_NewFrame();
-                g_d3d12.render_imgui();
+                m_d3d12_desktop.render(draw_data, (ID3D12Device*)renderer_data->device, command_queue, swapchain.Get(), g_d3d12.srv_desc_heap.Get());
             }
         }
     }    
@@ -111,9 +642,29 @@ public:
         PLUGIN_LOG_ONCE("Example Device Reset");
 
         std::scoped_lock _{ m_imgui_mutex };
+        reset_device();
+    }
+
+    // From the present callbacks, which never wait for the game thread. False while it's building a frame,
+    // and the caller tries again on the next present.
+    bool try_reset_device() {
+        std::unique_lock lock{ m_imgui_mutex, std::try_to_lock };
 
+        if (!lock.owns_lock()) {
+            return false;
+        }
+
+        reset_device();
+        return true;
+    }
+
+    // With m_imgui_mutex held, the game thread mustn't build a frame while the backends shut down
+    void reset_device() {
         const auto renderer_data = API::get()->param()->renderer;
 
+        m_d3d11_desktop.reset();
+        m_d3d12_desktop.reset();
+
         if (renderer_data->renderer_type == UEVR_RENDERER_D3D11) {
             ImGui_ImplDX11_Shutdown();
             g_d3d11 = {};
@@ -126,6 +677,9 @@ public:
         }
 
         m_initialized = false;
+
+        // Snapshots built before the reset reference the old font texture
+        ++m_device_generation;
     }
 
     void on_post_render_vr_framework_dx11(ID3D11DeviceContext* context, ID3D11Texture2D* texture, ID3D11RenderTargetView* rtv) override {
@@ -138,15 +692,20 @@ public:
         }
 
         if (m_was_rendering_desktop) {
-            m_was_rendering_desktop = false;
-            on_device_reset();
+            m_was_rendering_desktop = !try_reset_device();
             return;
         }
 
-        std::scoped_lock _{ m_imgui_mutex };
+        const auto draw_data = acquire_draw_data();
 
+        if (draw_data == nullptr) {
+            return;
+        }
+
+        // What g_d3d11.render_imgui_vr() does, with the snapshot
         ImGui_ImplDX11_NewFrame();
-        g_d3d11.render_imgui_vr(context, rtv);
+        context->OMSetRenderTargets(1, &rtv, nullptr);
+        ImGui_ImplDX11_RenderDrawData(draw_data);
     }
 
     void on_post_render_vr_framework_dx12(ID3D12GraphicsCommandList* command_list, ID3D12Resource* rt, D3D12_CPU_DESCRIPTOR_HANDLE* rtv) override {
@@ -159,103 +718,196 @@ public:
         }
 
         if (m_was_rendering_desktop) {
-            m_was_rendering_desktop = false;
-            on_device_reset();
+            m_was_rendering_desktop = !try_reset_device();
             return;
         }
 
-        std::scoped_lock _{ m_imgui_mutex };
+        const auto draw_data = acquire_draw_data();
+
+        if (draw_data == nullptr) {
+            return;
+        }
 
+        // What g_d3d12.render_imgui_vr() does, with the snapshot
+        ID3D12DescriptorHeap* heaps[]{ g_d3d12.srv_desc_heap.Get() };
         ImGui_ImplDX12_NewFrame();
-        g_d3d12.render_imgui_vr(command_list, rtv);
+        command_list->OMSetRenderTargets(1, rtv, FALSE, nullptr);
+        command_list->SetDescriptorHeaps(1, heaps);
+        ImGui_ImplDX12_RenderDrawData(draw_data, command_list);
     }
 
     bool on_message(HWND hwnd, UINT msg, WPARAM wparam, LPARAM lparam) override {
         ImGui_ImplWin32_WndProcHandler(hwnd, msg, wparam, lparam);
 
+        if (!m_ui_visible) {
+            return true;
+        }
+
         return !ImGui::GetIO().WantCaptureMouse && !ImGui::GetIO().WantCaptureKeyboard;
     }
 
     void on_pre_engine_tick(API::UGameEngine* engine, float delta) override {
         PLUGIN_LOG_ONCE("Pre Engine Tick: %f", delta);
 
-        if (m_initialized) {
-            std::scoped_lock _{ m_imgui_mutex };
+        if (!m_initialized) {
+            return;
+        }
 
-            ImGui_ImplWin32_NewFrame();
-            ImGui::NewFrame();
+        if (!is_ui_visible()) {
+            // Idle: no UI work at all until the overlay is shown again
+            m_ui_visible = false;
+            return;
+        }
+
+        m_ui_visible = true;
 
-            //API::get()->log_info("Running imgui internal_frame");
-            internal_frame();
+        // Only serialized against the backends shutting down on a device reset, drawing never takes the lock
+        std::scoped_lock _{ m_imgui_mutex };
 
-            ImGui::EndFrame();
-            ImGui::Render();
+        // The reset may have happened while we waited
+        if (!m_initialized) {
+            return;
         }
+
+        ImGui_ImplWin32_NewFrame();
+        ImGui::NewFrame();
+
+        //API::get()->log_info("Running imgui internal_frame");
+        internal_frame();
+
+        ImGui::EndFrame();
+        ImGui::Render();
+
+        if (ImGui::GetIO().WantSaveIniSettings) {
+            m_file_writer.write(imguiinipath, ImGui::SaveIniSettingsToMemory());
+            ImGui::GetIO().WantSaveIniSettings = false;
+        }
+
+        // Hand the finished frame to the render thread, it never touches the live ImGui state
+        m_draw_data.back().assign(ImGui::GetDrawData(), m_device_generation.load(std::memory_order_acquire));
+        m_draw_data.publish();
     }
 
     void on_post_engine_tick(API::UGameEngine* engine, float delta) override {
-        sinceincrease = sinceincrease + delta;
-        sincedecrease = sincedecrease + delta;
-        int usage = get_gpu_usage();
-        if (usage == -1) {
-            return;
-        }
-        // aim to keep the usage between 82 & 92 percent
-        // increase infrequently only by 5%, every 5 seconds at most, to prevent too many hitches
-        // decrease often and by 10%, every 0.5 seconds if needed, so we're not below target too long        
-        if (usage <= usagelowerbound && screenpercentage < 100) {
-            framesunderbudget = framesunderbudget + 1;
-            if (framesunderbudget > increaseframesrequired) {
-                screenpercentage = screenpercentage + increaseresamount;
+        // External edits to the config files take effect between ticks, never halfway through one
+        reload_config();
 
-                lastchange = std::format("Increased res to: {}%% after {:.2f} secs. Usage was {}%%", static_cast<int>(screenpercentage),
-                    static_cast<float>(sinceincrease), static_cast<int>(usage));
-                API::get()->log_info(lastchange.c_str());
-                sinceincrease = 0;
-                framesunderbudget = 0;
-                lastchange_time = std::time(nullptr);
-            }
+        update_hmd_resolution();
+        update_engine_caps(delta);
+
+        // A running sweep or auto-tune owns the screen percentage until it's done
+        autoscaler::Decision decision{};
+
+        if (m_calibration.has_value()) {
+            decision = calibration_tick(delta);
+        }
+        else if (m_autotune.has_value()) {
+            decision = autotune_tick(delta);
         }
         else {
-            framesunderbudget = 0;
+            decision = m_pipeline.tick(delta);
         }
-        if (usage >= usageupperbound && screenpercentage >= 20) {
-            framesoverbudget = framesoverbudget + 1;
-            if (framesoverbudget > decreaseframesrequired) {
-                screenpercentage = screenpercentage - decreaseresamount;
 
-                lastchange = std::format("Decreased res to:{}%% after {:.2f} secs. Usage was {}%%", static_cast<int>(screenpercentage), static_cast<float>(sinceincrease), static_cast<int>(usage));
-                API::get()->log_info(lastchange.c_str());
-                sincedecrease = 0;
-                framesoverbudget = 0;
-                lastchange_time = std::time(nullptr);
-            }
+        lastusage = decision.usage;
+        lastp95 = decision.frame_p95_ms;
+        lastp99 = decision.frame_p99_ms;
+
+        lastdamping = decision.damping;
+        lastcycles = m_controller.cycles();
+        lastrefreshms = static_cast<float>(m_controller.vsync().interval_ms());
+        lastmissed = m_controller.vsync().missed(1.0f);
+        lastcapms = static_cast<float>(m_controller.frame_cap().cap_ms());
+
+        // Raw deltas, hitches included, they're part of how frames were delivered
+        const auto refresh_ms = m_controller.vsync().quantized() ? m_controller.vsync().interval_ms() : 0.0;
+        m_pacing.add(delta, autoscaler::refresh_intervals(delta, refresh_ms));
+
+        float longest_present = 0.0f;
+        m_presents.drain([&](float seconds) {
+            m_present_pacing.add(seconds, autoscaler::refresh_intervals(seconds, refresh_ms));
+            longest_present = std::max(longest_present, seconds);
+        });
+
+        if (decision.scene_change) {
+            ++scenechanges;
         }
-        else {
-            framesoverbudget = 0;
+
+        if (decision.hitch == autoscaler::Hitch::Frame) {
+            ++framehitches;
+        }
+        else if (decision.hitch == autoscaler::Hitch::Usage) {
+            ++usagehitches;
+        }
+
+        // Taken here rather than in the UI, the window's statistics use scratch space the engine thread owns
+        if (const auto window_ms = std::max(settings.increasewindowms, settings.decreasewindowms); window_ms > 0) {
+            const auto& window = m_controller.window();
+            lastwindowmedian = window.median(window_ms / 1000.0f);
+            lastwindowmean = window.trimmed_mean(window_ms / 1000.0f, 0.1f);
+        }
+
+        if (m_recorder != nullptr) {
+            autoscaler::TraceRecord record{};
+            record.time_us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_recorder_start).count();
+            record.delta_us = static_cast<int64_t>(delta * 1'000'000.0);
+            record.usage = decision.usage;
+            record.band = decision.band;
+            record.action = decision.action;
+            record.screen_percentage = decision.screen_percentage;
+            record.frame_p95_us = static_cast<int64_t>(decision.frame_p95_ms * 1000.0f);
+            record.frame_p99_us = static_cast<int64_t>(decision.frame_p99_ms * 1000.0f);
+            record.hitch = decision.hitch;
+            record.damping = decision.damping;
+            record.missed = decision.missed;
+            record.present_us = static_cast<int64_t>(longest_present * 1'000'000.0f);
+            record.capped = decision.capped;
+            m_recorder->record(record);
+        }
+
+        if (decision.action == autoscaler::Action::Increase) {
+            lastchange = std::format("Increased res to: {}%% after {:.2f} secs. Usage was {}%%", decision.screen_percentage,
+                decision.seconds_since_last, decision.usage);
+            API::get()->log_info(lastchange.c_str());
+            lastchange_time = std::time(nullptr);
+        }
+        else if (decision.action == autoscaler::Action::Decrease) {
+            lastchange = std::format("Decreased res to:{}%% after {:.2f} secs. Usage was {}%%", decision.screen_percentage,
+                decision.seconds_since_last, decision.usage);
+            API::get()->log_info(lastchange.c_str());
+            lastchange_time = std::time(nullptr);
         }
-        std::wstring command = L"r.ScreenPercentage ";
-        command.append(std::to_wstring(screenpercentage));
-        API::get()->sdk()->functions->execute_command(command.c_str());
 
         lasttick = std::chrono::high_resolution_clock::now();
     }
 
 private:
-    int screenpercentage = 50;
-    float sinceincrease = 0;
-    float sincedecrease = 0;
-    int framesoverbudget = 0;
-    int framesunderbudget = 0;
-    int usagelowerbound = 82;
-    int usageupperbound = 92;
-    int decreaseresamount = 2;
-    int increaseresamount = 1;
-    int decreaseframesrequired = 10;
-    int increaseframesrequired = 20;
+    autoscaler::Settings settings{};
+    int lastusage = -1;
+    float lastp95 = 0.0f;
+    float lastp99 = 0.0f;
+    int framehitches = 0;
+    int usagehitches = 0;
+    int scenechanges = 0;
+    int lastdamping = 0;
+    int lastcycles = 0;
+    float lastrefreshms = 0.0f;
+    int lastmissed = 0;
+    float lastcapms = 0.0f;
+    float sincecapsread = 1.0f;
+    float lastwindowmedian = 0.0f;
+    float lastwindowmean = 0.0f;
     std::string lastchange = "";
     std::time_t lastchange_time = std::time(0);
     std::string configpath = "";
+    std::string imguiinipath = "";
+    std::string profilespath = "";
+    std::filesystem::path tracesdir{};
+    std::string calibrationpath = "";
+    nlohmann::json calibrations = nlohmann::json::object();
+    std::string hmdresolution = "";
+    nlohmann::json profiles{};
+    int activeprofile = -1;
+    nlohmann::json lastsavedconfig{}; // the generic config as last read or written
     std::chrono::high_resolution_clock::time_point lasttick = std::chrono::high_resolution_clock::now();
     bool isloading2d = false;
 
@@ -273,27 +925,11 @@ private:
         return std::filesystem::path(path).parent_path().string();
     }
 
-    int get_gpu_usage() {
-        static bool initialized = false;
-        static nvmlDevice_t device;
+    std::string get_exe_name() {
+        char path[MAX_PATH] = {};
+        GetModuleFileNameA(nullptr, path, MAX_PATH);
 
-        if (!initialized) {
-            API::get()->log_info("Init start");
-            if (nvmlInit() != NVML_SUCCESS)
-                return -1;
-            if (nvmlDeviceGetHandleByIndex(0, &device) != NVML_SUCCESS)
-                return -1;
-            initialized = true;
-            API::get()->log_info("Init done");
-        }
-
-        nvmlUtilization_t utilization;
-        if (nvmlDeviceGetUtilizationRates(device, &utilization) == NVML_SUCCESS) {
-            //API::get()->log_info("Returning usage");
-            return utilization.gpu;
-        }
-
-        return -1;
+        return std::filesystem::path(path).filename().string();
     }
 
     bool initialize_imgui() {
@@ -303,13 +939,14 @@ private:
             return true;
         }
 
-        std::scoped_lock _{ m_imgui_mutex };
-
+        // No lock: this runs on the render thread like the reset, and the game thread leaves ImGui alone
+        // until m_initialized is set at the end
         IMGUI_CHECKVERSION();
         ImGui::CreateContext();
 
-        static const auto imgui_ini = API::get()->get_persistent_dir(L"imgui_example_plugin.ini").string();
-        ImGui::GetIO().IniFilename = imgui_ini.c_str();
+        // ImGui would otherwise save the ini itself from NewFrame on the game thread
+        ImGui::GetIO().IniFilename = nullptr;
+        ImGui::LoadIniSettingsFromDisk(imguiinipath.c_str());
 
         const auto renderer_data = API::get()->param()->renderer;
 
@@ -334,55 +971,314 @@ private:
             }
         }
 
+        // Create the font texture now, so the game thread never builds a frame before it exists
+        if (renderer_data->renderer_type == UEVR_RENDERER_D3D11) {
+            ImGui_ImplDX11_NewFrame();
+        }
+        else if (renderer_data->renderer_type == UEVR_RENDERER_D3D12) {
+            ImGui_ImplDX12_NewFrame();
+        }
+
         API::get()->log_info("Init imgui done");
 
         m_initialized = true;
         return true;
     }
 
+    // The overlay is only shown while UEVR's own menu is open
+    bool is_ui_visible() {
+        return API::get()->param()->functions->is_drawing_ui();
+    }
+
+    // Render thread only. The newest frame the game thread finished, while the overlay is showing and if it
+    // was built since the last device reset.
+    ImDrawData* acquire_draw_data() {
+        auto& snapshot = m_draw_data.acquire();
+
+        if (!m_ui_visible || !snapshot.draw_data.Valid || snapshot.generation != m_device_generation.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+
+        return &snapshot.draw_data;
+    }
+
     // Load values from JSON config file
     void load_config() {
         std::ifstream configFile(configpath);
         if (configFile.is_open()) {
-            nlohmann::json j;
-            configFile >> j;
-
-            if (j.contains("usagelowerbound")) {
-                usagelowerbound = j["usagelowerbound"];
-            }
-            if (j.contains("usageupperbound")) {
-                usageupperbound = j["usageupperbound"];
-            }
-            if (j.contains("decreaseframesrequired")) {
-                decreaseframesrequired = j["decreaseframesrequired"];
-            }
-            if (j.contains("increaseframesrequired")) {
-                increaseframesrequired = j["increaseframesrequired"];
-            }
-            if (j.contains("decreaseresamount")) {
-                decreaseresamount = j["decreaseresamount"];
+            // A hand edited file can be broken, the defaults are better than failing to start
+            auto j = nlohmann::json::parse(configFile, nullptr, false);
+            if (j.is_discarded() || !j.is_object()) {
+                API::get()->log_warn("Ignoring unreadable config %s, using the defaults", configpath.c_str());
+                return;
             }
-            if (j.contains("increaseresamount")) {
-                increaseresamount = j["increaseresamount"];
+
+            apply_config(j);
+            lastsavedconfig = j;
+        }
+    }
+
+    // Our own writes come back from the watchers too, they're recognized by matching what we saved
+    void reload_config() {
+        auto config = m_config_watcher->take();
+        auto store = m_profiles_watcher->take();
+        const auto config_changed = config.has_value() && *config != lastsavedconfig;
+        const auto store_changed = store.has_value() && *store != profiles;
+
+        if (!config_changed && !store_changed) {
+            return;
+        }
+
+        if (config_changed) {
+            lastsavedconfig = std::move(*config);
+            API::get()->log_info("Reloaded config from %s", configpath.c_str());
+        }
+
+        if (store_changed) {
+            profiles = std::move(*store);
+            API::get()->log_info("Reloaded profiles from %s", profilespath.c_str());
+        }
+
+        // Layered again from the defaults up, the same way they were loaded at startup
+        settings = {};
+
+        if (lastsavedconfig.is_object()) {
+            apply_config(lastsavedconfig);
+        }
+
+        apply_profiles(profiles);
+        m_controller.set_settings(settings);
+        update_recorder();
+    }
+
+    // One trace per session, named after when it started
+    void update_recorder() {
+        if (settings.telemetry && m_recorder == nullptr) {
+            const auto name = std::format("autoscaler-{:%Y%m%d-%H%M%S}.trace", std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now()));
+            m_recorder = std::make_unique<autoscaler::TelemetryRecorder>(tracesdir / name);
+            m_recorder_start = std::chrono::steady_clock::now();
+            API::get()->log_info("Recording telemetry to %s", m_recorder->path().string().c_str());
+        }
+        else if (!settings.telemetry && m_recorder != nullptr) {
+            if (m_recorder->dropped() > 0) {
+                API::get()->log_warn("Telemetry dropped %d records", static_cast<int>(m_recorder->dropped()));
             }
+
+            // The writer finishes the file on its own thread. The recorder it replaces was closed long
+            // before, so destroying that one doesn't wait on any I/O either.
+            m_recorder->close();
+            m_closed_recorder = std::move(m_recorder);
+        }
+    }
+
+    void apply_config(const nlohmann::json& j) {
+        if (!autoscaler::apply_settings(j, settings)) {
+            API::get()->log_warn("Unknown sensor or controller in config, using %s and %s", settings.sensor.c_str(), settings.controller.c_str());
         }
+
+        m_controller.set_settings(settings);
+    }
+
+    // Per-game profiles override the generic autoscalerconfig.json, which is only used when no profile matches
+    void load_profile() {
+        std::ifstream profilesFile(profilespath);
+        if (!profilesFile.is_open()) {
+            return;
+        }
+
+        auto j = nlohmann::json::parse(profilesFile, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) {
+            API::get()->log_warn("Ignoring unreadable profiles %s", profilespath.c_str());
+            return;
+        }
+
+        apply_profiles(j);
+    }
+
+    void apply_profiles(const nlohmann::json& j) {
+        profiles = j;
+        activeprofile = autoscaler::select_profile(profiles, get_exe_name(),
+            API::get()->param()->functions->get_commit_hash(), API::get()->param()->functions->get_tag());
+
+        if (activeprofile >= 0) {
+            const auto& profile = profiles["profiles"][activeprofile];
+            apply_config(profile);
+            API::get()->log_info("Using profile %d for %s", activeprofile, profile["game"].get<std::string>().c_str());
+        }
+    }
+
+    const std::string& active_config_path() const {
+        return activeprofile >= 0 ? profilespath : configpath;
+    }
+
+    // One cost table per headset resolution, the same game renders very differently on another headset
+    void load_calibrations() {
+        std::ifstream calibrationFile(calibrationpath);
+        if (!calibrationFile.is_open()) {
+            return;
+        }
+
+        auto j = nlohmann::json::parse(calibrationFile, nullptr, false);
+        if (j.is_discarded() || !j.is_object()) {
+            API::get()->log_warn("Ignoring unreadable calibration %s", calibrationpath.c_str());
+            return;
+        }
+
+        calibrations = j;
+    }
+
+    // The headset's resolution is only known once it's running, so the table is picked up lazily
+    void update_hmd_resolution() {
+        const auto vr = API::get()->param()->vr;
+
+        if (!vr->is_hmd_active()) {
+            return;
+        }
+
+        const auto resolution = std::format("{}x{}", vr->get_hmd_width(), vr->get_hmd_height());
+
+        if (resolution == hmdresolution) {
+            return;
+        }
+
+        hmdresolution = resolution;
+
+        autoscaler::CostTable table{};
+
+        if (calibrations.contains(hmdresolution) && !autoscaler::apply_cost_table(calibrations[hmdresolution], table)) {
+            API::get()->log_warn("Ignoring unreadable calibration for %s", hmdresolution.c_str());
+        }
+
+        m_controller.set_cost_table(table);
+
+        if (!table.empty()) {
+            API::get()->log_info("Using calibration for %s", hmdresolution.c_str());
+        }
+    }
+
+    // Frame caps set through console variables. Games change them at runtime, e.g. around menus, so they're
+    // read again every so often. Cutscene caps usually have no variable, the controller spots those itself.
+    void update_engine_caps(float delta) {
+        sincecapsread += delta;
+
+        if (sincecapsread < 1.0f) {
+            return;
+        }
+
+        sincecapsread = 0.0f;
+
+        const auto console = API::get()->get_console_manager();
+
+        if (console == nullptr) {
+            return;
+        }
+
+        const auto max_fps = console->find_variable(L"t.MaxFPS");
+        const auto vsync = console->find_variable(L"r.VSync");
+        const auto sync_interval = console->find_variable(L"rhi.SyncInterval");
+
+        // rhi.SyncInterval only holds frames to more than one refresh while vsync is on. Without r.VSync
+        // we can't tell, and a cap that isn't there would hide real missed refreshes.
+        const auto vsync_on = vsync != nullptr && vsync->get_int() != 0;
+        m_controller.set_engine_caps(max_fps != nullptr ? max_fps->get_float() : 0.0f,
+            vsync_on && sync_interval != nullptr ? sync_interval->get_int() : 0);
+    }
+
+    void start_calibration() {
+        autoscaler::CalibrationOptions options{};
+        options.min_screen_percentage = settings.minscreenpercentage;
+        options.max_screen_percentage = settings.maxscreenpercentage;
+        m_calibration.emplace(options);
+        API::get()->log_info("Calibrating %d%% to %d%% for %s", options.min_screen_percentage, options.max_screen_percentage, hmdresolution.c_str());
+    }
+
+    autoscaler::Decision calibration_tick(float delta) {
+        autoscaler::Decision decision{};
+        decision.usage = m_sensor.read_usage();
+        decision.screen_percentage = m_calibration->tick(delta, decision.usage);
+        m_actuator.apply(decision.screen_percentage);
+
+        if (m_calibration->done()) {
+            finish_calibration();
+        }
+
+        return decision;
+    }
+
+    void finish_calibration() {
+        const auto table = m_calibration->table();
+        m_calibration.reset();
+
+        if (table.empty() || hmdresolution.empty()) {
+            lastchange = "Calibration failed, no GPU usage readings";
+            API::get()->log_warn(lastchange.c_str());
+            return;
+        }
+
+        calibrations[hmdresolution] = autoscaler::cost_table_to_json(table);
+        m_file_writer.write(calibrationpath, calibrations.dump(4));
+        m_controller.set_cost_table(table);
+
+        lastchange = std::format("Calibrated {} levels for {}", table.points.size(), hmdresolution);
+        API::get()->log_info(lastchange.c_str());
+        lastchange_time = std::time(nullptr);
+    }
+
+    void start_autotune() {
+        m_autotune.emplace(settings, m_controller.screen_percentage());
+        API::get()->log_info("Auto-tuning around %d%%", m_autotune->screen_percentage());
+    }
+
+    autoscaler::Decision autotune_tick(float delta) {
+        autoscaler::Decision decision{};
+        decision.usage = m_sensor.read_usage();
+        decision.screen_percentage = m_autotune->tick(delta, decision.usage);
+        m_actuator.apply(decision.screen_percentage);
+
+        if (m_autotune->done()) {
+            finish_autotune();
+        }
+
+        return decision;
+    }
+
+    // The tuned values go into the game's profile or config like any change made with the sliders
+    void finish_autotune() {
+        const auto result = m_autotune->result();
+        const auto succeeded = m_autotune->succeeded();
+        m_autotune.reset();
+
+        if (!succeeded) {
+            lastchange = "Auto-tune failed, usage never reached the band. Try a GPU heavy scene";
+            API::get()->log_warn(lastchange.c_str());
+            return;
+        }
+
+        settings = autoscaler::relay_tuned_settings(settings, result);
+        m_controller.set_settings(settings);
+        save_config();
+
+        lastchange = std::format("Auto-tuned: period {:.2f} secs, {} frames before decreasing, {} before increasing", result.period_seconds,
+            settings.decreaseframesrequired, settings.increaseframesrequired);
+        API::get()->log_info(lastchange.c_str());
+        lastchange_time = std::time(nullptr);
     }
 
     void save_config() {
-        nlohmann::json j;
-        j["usagelowerbound"] = usagelowerbound;
-        j["usageupperbound"] = usageupperbound;
-        j["decreaseframesrequired"] = decreaseframesrequired;
-        j["increaseframesrequired"] = increaseframesrequired;
-        j["decreaseresamount"] = decreaseresamount;
-        j["increaseresamount"] = increaseresamount;
-
-        API::get()->log_info("Saving config");
-        std::ofstream configFile(configpath);
-        if (configFile.is_open()) {
-            API::get()->log_info("Opened file");
-            configFile << j.dump(4); // Pretty print with 4-space indent
+        auto j = autoscaler::settings_to_json(settings);
+
+        // Changes made while a profile is active belong to that profile, not the generic config.
+        // Either is remembered so the watchers don't treat our own write as an external edit.
+        if (activeprofile >= 0) {
+            profiles["profiles"][activeprofile].update(j);
+            j = profiles;
+        }
+        else {
+            lastsavedconfig = j;
         }
+
+        // Queued rather than written here, slider drags would otherwise rewrite the file every frame
+        m_file_writer.write(active_config_path(), j.dump(4)); // Pretty print with 4-space indent
     }
 
     void internal_frame() {
@@ -397,37 +1293,156 @@ private:
             ImGui::Text("When GPU usage is below \"Usage Lower Bound\"");
             ImGui::Text("for consecutive \"Frames Before Increasing\"");
             ImGui::Text("then percentage is changed by \"Increase Res By\"");
-            if (ImGui::SliderInt("Usage Lower Bound", &usagelowerbound, 60, 95)) {
+            if (ImGui::SliderInt("Usage Lower Bound", &settings.usagelowerbound, 60, 95)) {
                 changed = true;
-                if (usageupperbound <= usagelowerbound + 5) {
-                    usageupperbound = usagelowerbound + 5;
+                if (settings.usageupperbound <= settings.usagelowerbound + 5) {
+                    settings.usageupperbound = settings.usagelowerbound + 5;
                 }
             }
-            if (ImGui::SliderInt("Frames Before Increasing", &increaseframesrequired, 1, 1000)) {
+            if (ImGui::SliderInt("Frames Before Increasing", &settings.increaseframesrequired, 1, 1000)) {
                 changed = true;
             }
-            if (ImGui::SliderInt("Increase Res By", &increaseresamount, 1, 20)) {
+            if (ImGui::SliderInt("Increase Res By", &settings.increaseresamount, 1, 20)) {
                 changed = true;
             }
             ImGui::Text("When GPU usage is above \"Usage Upper Bound\"");
             ImGui::Text("for consecutive \"Frames Before Decreasing\"");
             ImGui::Text("then percentage is changed by \"Decrease Res By\"");
-            if (ImGui::SliderInt("Usage Upper Bound", &usageupperbound, 60, 95)) {
+            if (ImGui::SliderInt("Usage Upper Bound", &settings.usageupperbound, 60, 95)) {
                 changed = true;
-                if (usagelowerbound >= usageupperbound - 5) {
-                    usagelowerbound = usageupperbound - 5;
+                if (settings.usagelowerbound >= settings.usageupperbound - 5) {
+                    settings.usagelowerbound = settings.usageupperbound - 5;
                 }
             }
-            if (ImGui::SliderInt("Frames Before Decreasing", &decreaseframesrequired, 1, 1000)) {
+            if (ImGui::SliderInt("Frames Before Decreasing", &settings.decreaseframesrequired, 1, 1000)) {
+                changed = true;
+            }
+
+            if (ImGui::SliderInt("Decrease Res By", &settings.decreaseresamount, 1, 20)) {
+                changed = true;
+            }
+            if (ImGui::SliderInt("Min Screen Percentage", &settings.minscreenpercentage, 10, 100)) {
+                changed = true;
+                settings.maxscreenpercentage = std::max(settings.maxscreenpercentage, settings.minscreenpercentage);
+            }
+            if (ImGui::SliderInt("Max Screen Percentage", &settings.maxscreenpercentage, 10, 200)) {
                 changed = true;
+                settings.minscreenpercentage = std::min(settings.minscreenpercentage, settings.maxscreenpercentage);
             }
 
-            if (ImGui::SliderInt("Decrease Res By", &decreaseresamount, 1, 20)) {
+            ImGui::Text("A window other than 0 replaces the consecutive frames");
+            ImGui::Text("with \"Window Share\" of that much recent time");
+            if (ImGui::SliderInt("Increase Window (ms)", &settings.increasewindowms, 0, autoscaler::MAX_WINDOW_MS)) {
+                changed = true;
+            }
+            if (ImGui::SliderInt("Decrease Window (ms)", &settings.decreasewindowms, 0, autoscaler::MAX_WINDOW_MS)) {
+                changed = true;
+            }
+            if (ImGui::SliderInt("Window Share %", &settings.windowshare, 50, 100)) {
+                changed = true;
+            }
+
+            static const char* tails[] = { "off", "p95", "p99" };
+            int tail = settings.tailpercentile == 99 ? 2 : settings.tailpercentile == 95 ? 1 : 0;
+            if (ImGui::Combo("Frame Time Target", &tail, tails, IM_ARRAYSIZE(tails))) {
+                changed = true;
+                settings.tailpercentile = tail == 2 ? 99 : tail == 1 ? 95 : 0;
+            }
+            if (ImGui::SliderInt("Frame Time Window (ms)", &settings.tailwindowms, 500, autoscaler::MAX_WINDOW_MS)) {
+                changed = true;
+            }
+            if (ImGui::SliderInt("Missed Frames Per Second", &settings.missedframes, 0, 60)) {
                 changed = true;
             }
 
 
+            if (ImGui::Checkbox("Record Telemetry", &settings.telemetry)) {
+                changed = true;
+                update_recorder();
+            }
+
+            static const char* controllers[] = { "step", "predictive", "probe", "cascade" };
+            int controller = static_cast<int>(std::find(std::begin(controllers), std::end(controllers), settings.controller) - std::begin(controllers));
+            if (ImGui::Combo("Controller", &controller, controllers, IM_ARRAYSIZE(controllers))) {
+                changed = true;
+                settings.controller = controllers[controller];
+            }
+
+            if (settings.controller == "cascade") {
+                if (ImGui::SliderInt("Inner Missed Frames", &settings.innerframes, 1, 10)) {
+                    changed = true;
+                }
+                if (ImGui::SliderInt("Inner Step", &settings.innerstep, 1, 20)) {
+                    changed = true;
+                }
+                if (ImGui::SliderInt("Inner Max Trim", &settings.innermaxtrim, settings.innerstep, 50)) {
+                    changed = true;
+                }
+                if (ImGui::SliderInt("Inner Recovery (ms)", &settings.innerrecoveryms, 100, 5000)) {
+                    changed = true;
+                }
+                if (ImGui::SliderInt("Outer Time (ms)", &settings.outertimems, 100, 20000)) {
+                    changed = true;
+                }
+            }
+
+            if (ImGui::Checkbox("Use Calibration", &settings.usecalibration)) {
+                changed = true;
+            }
+
+            if (ImGui::Checkbox("Ignore Hitches", &settings.hitchfilter)) {
+                changed = true;
+            }
+
+            if (ImGui::Checkbox("Detect Scene Changes", &settings.changedetection)) {
+                changed = true;
+            }
+
+            if (ImGui::Checkbox("Damp Oscillation", &settings.oscillationdamping)) {
+                changed = true;
+            }
+
+            if (ImGui::Checkbox("Detect Frame Caps", &settings.capdetection)) {
+                changed = true;
+            }
+
+            if (settings.capdetection && ImGui::Checkbox("Raise Quality During Caps", &settings.raiseduringcaps)) {
+                changed = true;
+            }
+
+            if (m_calibration.has_value()) {
+                ImGui::Text("Calibrating at %d%%, %.0f%% done", m_calibration->screen_percentage(), m_calibration->progress() * 100.0f);
+
+                if (ImGui::Button("Cancel Calibration")) {
+                    m_calibration.reset();
+                }
+            }
+            else if (m_autotune.has_value()) {
+                ImGui::Text("Auto-tuning at %d%%, %.0f%% done", m_autotune->screen_percentage(), m_autotune->progress() * 100.0f);
+
+                if (ImGui::Button("Cancel Auto-Tune")) {
+                    m_autotune.reset();
+                }
+            }
+            else {
+                // Close the menu and look at a typical part of the scene while either runs
+                if (ImGui::Button("Calibrate")) {
+                    start_calibration();
+                }
+
+                ImGui::SameLine();
+
+                if (ImGui::Button("Auto-Tune")) {
+                    start_autotune();
+                }
+            }
+
+            if (!m_controller.cost_table().empty()) {
+                ImGui::Text("Calibrated for %s", hmdresolution.c_str());
+            }
+
             if (changed) {
+                m_controller.set_settings(settings);
                 save_config();
             }
 
@@ -441,18 +1456,93 @@ private:
                 // Print formatted time using ImGui
                 ImGui::Text("Last changed %.0f secs ago", seconds_diff);
             }
+            if (activeprofile >= 0) {
+                ImGui::Text("Using profile for %s", profiles["profiles"][activeprofile]["game"].get<std::string>().c_str());
+            }
             ImGui::Text(lastchange.c_str());
-            ImGui::Text("GPU usage is %d%%", get_gpu_usage());
+            ImGui::Text("GPU usage is %d%%", lastusage);
+            ImGui::Text("Frame time p95 %.1f ms, p99 %.1f ms", lastp95, lastp99);
+            if (lastrefreshms > 0.0f) {
+                ImGui::Text("Refresh %.1f Hz, %d missed in the last second", 1000.0f / lastrefreshms, lastmissed);
+            }
+            if (lastcapms > 0.0f) {
+                ImGui::Text("Frame capped at %.0f fps", 1000.0f / lastcapms);
+            }
+            ImGui::Text("Hitches ignored: %d frame, %d usage", framehitches, usagehitches);
+            ImGui::Text("Scene changes detected: %d", scenechanges);
+            ImGui::Text("Up and down cycles: %d, damping level %d", lastcycles, lastdamping);
+            if (settings.increasewindowms > 0 || settings.decreasewindowms > 0) {
+                ImGui::Text("Window median %.0f%%, trimmed mean %.0f%%", lastwindowmedian, lastwindowmean);
+            }
+
+            if (ImGui::CollapsingHeader("Frame Pacing")) {
+                draw_pacing("Engine", m_pacing);
+
+                if (m_present_pacing.session().frames > 0) {
+                    draw_pacing("Present", m_present_pacing);
+                }
+
+                if (ImGui::Button("Reset Pacing")) {
+                    m_pacing.clear();
+                    m_present_pacing.clear();
+                }
+            }
         }
         //API::get()->log_info("Internal frame done");
     }
 
+    // Frame times of the recent frames, how many took 1, 2 and 3+ refresh intervals, and the numbers for the session
+    void draw_pacing(const char* label, const autoscaler::PacingAnalyzer& pacing) {
+        const auto recent = pacing.recent();
+        const auto session = pacing.session();
+        const auto& history = pacing.history();
+        const auto scale = lastrefreshms > 0.0f ? 3.0f * lastrefreshms : 50.0f;
+
+        ImGui::PushID(label);
+        ImGui::PlotLines("##frametimes", history.data(), static_cast<int>(history.size()), static_cast<int>(pacing.history_offset()),
+            label, 0.0f, scale, ImVec2(0, 60));
+
+        const float intervals[] = { static_cast<float>(recent.intervals[0]), static_cast<float>(recent.intervals[1]), static_cast<float>(recent.intervals[2]) };
+        ImGui::PlotHistogram("##intervals", intervals, IM_ARRAYSIZE(intervals), 0, "1 / 2 / 3+ intervals", 0.0f,
+            static_cast<float>(std::max(recent.frames, 1)), ImVec2(0, 40));
+
+        ImGui::Text("Recent: sd %.2f ms, judder %.1f, longest %.1f ms", recent.stddev_ms, recent.judder, recent.longest_ms);
+        ImGui::Text("Session: %d / %d / %d frames at 1 / 2 / 3+ intervals", session.intervals[0], session.intervals[1], session.intervals[2]);
+        ImGui::Text("Session: sd %.2f ms, judder %.1f, longest stall %.1f ms", session.stddev_ms, session.judder, session.longest_ms);
+        ImGui::PopID();
+    }
+
 private:
     HWND m_wnd{};
-    bool m_initialized{ false };
+    std::atomic<bool> m_initialized{ false };
+    std::atomic<bool> m_ui_visible{ false };
     bool m_was_rendering_desktop{ false };
 
+    // Only guards building a frame against the backends shutting down, never taken per frame on the render thread
     std::recursive_mutex m_imgui_mutex{};
+
+    DrawDataTripleBuffer m_draw_data{};
+    std::atomic<uint32_t> m_device_generation{ 0 };
+    D3D11DesktopOverlay m_d3d11_desktop{};
+    D3D12DesktopOverlay m_d3d12_desktop{};
+    autoscaler::Controller m_controller{};
+    NvmlSensor m_sensor{};
+    ScreenPercentageActuator m_actuator{};
+    autoscaler::Pipeline m_pipeline{ m_sensor, m_controller, m_actuator };
+    std::optional<autoscaler::CalibrationSweep> m_calibration{};
+    std::optional<autoscaler::RelayAutoTune> m_autotune{};
+    autoscaler::PacingAnalyzer m_pacing{};
+    autoscaler::PacingAnalyzer m_present_pacing{};
+    // Seconds between presents, pushed by the render thread and drained by the engine thread
+    autoscaler::SpscRing<float, 256> m_presents{};
+    std::chrono::steady_clock::time_point m_last_present{}; // render thread only
+
+    DebouncedFileWriter m_file_writer{ std::chrono::milliseconds{ 1000 } };
+    std::unique_ptr<ConfigWatcher> m_config_watcher{};
+    std::unique_ptr<ConfigWatcher> m_profiles_watcher{};
+    std::unique_ptr<autoscaler::TelemetryRecorder> m_recorder{};
+    std::unique_ptr<autoscaler::TelemetryRecorder> m_closed_recorder{};
+    std::chrono::steady_clock::time_point m_recorder_start{};
 };
 
 // Actually creates the plugin. Very important that this global is created.
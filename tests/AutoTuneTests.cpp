@@ -0,0 +1,62 @@
+#include "autoscaler/AutoTune.hpp"
+#include "autoscaler/Simulator.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+RelayAutoTune run_relay(const PlantParams& params, int screen_percentage) {
+    Plant plant{ params, screen_percentage };
+    RelayAutoTune relay{ Settings{}, screen_percentage };
+
+    while (!relay.done()) {
+        const auto frame = plant.step();
+        plant.apply(relay.tick(static_cast<float>(frame.delta), frame.usage));
+    }
+
+    return relay;
+}
+}
+
+TEST_CASE("relay experiment measures the loop's oscillation") {
+    PlantParams params{};
+    params.noise = 0.01;
+
+    const auto relay = run_relay(params, 85);
+    CHECK(relay.succeeded());
+    CHECK(relay.progress() == 1.0f);
+
+    const auto& result = relay.result();
+    CHECK(result.period_seconds > 0.2 && result.period_seconds < 2.0);
+    CHECK(result.amplitude > 2.0 && result.amplitude < 30.0);
+    CHECK(result.frame_seconds >= 1.0 / 90.0 && result.frame_seconds < 2.0 / 90.0);
+}
+
+TEST_CASE("a slower sensor gets longer dwell times") {
+    PlantParams fast{};
+    fast.noise = 0.01;
+
+    PlantParams slow = fast;
+    slow.sensor_period = 0.5;
+    slow.sensor_delay_frames = 20;
+
+    const auto fast_settings = relay_tuned_settings(Settings{}, run_relay(fast, 85).result());
+    const auto slow_settings = relay_tuned_settings(Settings{}, run_relay(slow, 85).result());
+
+    CHECK(slow_settings.decreaseframesrequired > fast_settings.decreaseframesrequired);
+    CHECK(slow_settings.increaseframesrequired > fast_settings.increaseframesrequired);
+    CHECK(fast_settings.increaseresamount >= 1 && fast_settings.decreaseresamount >= fast_settings.increaseresamount);
+}
+
+TEST_CASE("relay gives up when usage never reaches the setpoint") {
+    PlantParams params{};
+    params.cpu_ms = 20.0; // CPU bound, the GPU idles whatever the resolution
+
+    const auto relay = run_relay(params, 85);
+    CHECK(relay.done());
+    CHECK(!relay.succeeded());
+
+    const Settings settings{};
+    CHECK(relay_tuned_settings(settings, relay.result()).decreaseframesrequired == settings.decreaseframesrequired);
+}
@@ -0,0 +1,52 @@
+#include "autoscaler/Benchmark.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("scorecard counts reversals, misses and settling time") {
+    ScorecardBuilder builder{ 1'000'000.0, 1.0 };
+
+    // before measure_from, ignored
+    builder.add(0.0, 1.0, 3, 10, Action::Decrease);
+
+    builder.add(1.0, 1.0, 1, 50, Action::Increase);
+    builder.add(2.0, 1.0, 2, 60, Action::Decrease);
+    builder.add(3.0, 1.0, 1, 100, Action::Increase);
+    builder.add(4.0, 1.0, 1, 99, Action::None);
+
+    const auto card = builder.finish();
+    CHECK_NEAR(card.changes, 3.0, 1e-9);
+    CHECK_NEAR(card.oscillations, 2.0, 1e-9);
+    CHECK_NEAR(card.over_budget_share, 0.25, 1e-9);
+    CHECK_NEAR(card.convergence_seconds, 2.0, 1e-9);
+    CHECK_NEAR(card.megapixels, (0.25 + 0.36 + 1.0 + 0.9801) / 4.0, 1e-9);
+}
+
+TEST_CASE("bootstrap interval brackets the mean and is deterministic") {
+    const std::vector<double> values{ 1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0, 8.0 };
+
+    const auto a = bootstrap_mean(values);
+    const auto b = bootstrap_mean(values);
+
+    CHECK_NEAR(a.mean, 4.5, 1e-9);
+    CHECK(a.low < a.mean && a.mean < a.high);
+    CHECK(a.low > 1.0 && a.high < 8.0);
+    CHECK(a.low == b.low && a.high == b.high);
+}
+
+TEST_CASE("scenarios are deterministic for a seed and cold start settles") {
+    for (const auto& scenario : standard_scenarios()) {
+        if (scenario.name != "cold_start") {
+            continue;
+        }
+
+        const auto a = run_scenario(scenario, Settings{}, 7);
+        const auto b = run_scenario(scenario, Settings{}, 7);
+
+        CHECK(a.megapixels == b.megapixels && a.changes == b.changes);
+        CHECK(a.changes > 0.0);
+        CHECK(a.over_budget_share < 0.05);
+        CHECK(a.convergence_seconds < scenario.seconds / 2.0);
+    }
+}
@@ -0,0 +1,73 @@
+#include "autoscaler/Calibration.hpp"
+#include "autoscaler/Simulator.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("cost table interpolates and inverts") {
+    CostTable table{};
+    table.points = { { 50, 4.0 }, { 70, 8.0 }, { 90, 12.0 } };
+
+    CHECK_NEAR(table.gpu_ms_at(60), 6.0, 1e-9);
+    CHECK_NEAR(table.gpu_ms_at(100), 14.0, 1e-9);
+    CHECK(table.screen_percentage_for(10.0) == 80);
+    CHECK(table.screen_percentage_for(1.0) == 50);
+    CHECK(table.screen_percentage_for(50.0) == 90);
+
+    // A noisy level that measured cheaper than the one below it doesn't open a gap
+    table.points = { { 50, 4.0 }, { 60, 7.0 }, { 70, 6.5 }, { 80, 9.0 } };
+    CHECK(table.screen_percentage_for(6.8) == 59);
+}
+
+TEST_CASE("cost table round trips through json") {
+    CostTable table{};
+    table.points = { { 70, 8.0, 11.1, 72 }, { 50, 4.0, 11.1, 36 } };
+
+    CostTable loaded{};
+    CHECK(apply_cost_table(cost_table_to_json(table), loaded));
+    CHECK(loaded.points.size() == 2);
+    CHECK(loaded.points[0].screen_percentage == 50);
+    CHECK(loaded.points[1].usage == 72);
+
+    CHECK(!apply_cost_table(nlohmann::json::parse(R"({ "points": [ { "gpums": 3 } ] })"), loaded));
+    CHECK(loaded.points.size() == 2);
+}
+
+TEST_CASE("sweep measures the plant's cost per level") {
+    PlantParams params{};
+    params.noise = 0.0;
+    params.gpu_ms_at_100 = 14.0;
+
+    Plant plant{ params, 50 };
+    CalibrationSweep sweep{};
+
+    for (int i = 0; i < 90 * 60 && !sweep.done(); ++i) {
+        const auto frame = plant.step();
+        plant.apply(sweep.tick(static_cast<float>(frame.delta), frame.usage));
+    }
+
+    CHECK(sweep.done());
+    CHECK(sweep.progress() == 1.0f);
+    CHECK(sweep.table().points.size() == 6);
+
+    // 100% misses the 90 Hz refresh, the busy time is still measured rather than the capped usage
+    for (const auto& point : sweep.table().points) {
+        CHECK_NEAR(point.gpu_ms, plant.gpu_ms(point.screen_percentage, 1.0), 0.25);
+    }
+}
+
+TEST_CASE("sweep moves on from levels the sensor never reports") {
+    CalibrationOptions options{};
+    options.min_screen_percentage = 60;
+    options.max_screen_percentage = 70;
+
+    CalibrationSweep sweep{ options };
+
+    for (int i = 0; i < 90 * 60 && !sweep.done(); ++i) {
+        sweep.tick(1.0f / 90.0f, -1);
+    }
+
+    CHECK(sweep.done());
+    CHECK(sweep.table().empty());
+}
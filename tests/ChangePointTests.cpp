@@ -0,0 +1,60 @@
+#include "autoscaler/ChangePoint.hpp"
+#include "autoscaler/Random.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+constexpr float FRAME = 1.0f / 90.0f;
+
+// Seconds until the detector fires, -1 if it doesn't within the given time
+float run(ChangeDetector& detector, Random& random, double level, double noise, float seconds) {
+    for (float t = 0.0f; t < seconds; t += FRAME) {
+        if (detector.add(FRAME, level + noise * random.gaussian())) {
+            return t;
+        }
+    }
+
+    return -1.0f;
+}
+}
+
+TEST_CASE("change detector stays quiet on noise") {
+    ChangeDetector detector{};
+    Random random{ 3 };
+
+    CHECK(run(detector, random, 80.0, 3.0, 120.0f) < 0.0f);
+}
+
+TEST_CASE("change detector fires on a scene transition within a fraction of a second") {
+    ChangeDetector detector{};
+    Random random{ 3 };
+    run(detector, random, 80.0, 3.0, 5.0f);
+
+    const auto fired = run(detector, random, 110.0, 3.0, 5.0f);
+    CHECK(fired >= 0.0f);
+    CHECK(fired < 0.75f);
+
+    // The mean restarts from the new level
+    CHECK(run(detector, random, 110.0, 3.0, 30.0f) < 0.0f);
+}
+
+TEST_CASE("change detector follows a slow ramp without firing") {
+    ChangeDetector detector{};
+    Random random{ 5 };
+
+    for (int second = 0; second < 60; ++second) {
+        CHECK(run(detector, random, 70.0 + second * 0.5, 2.0, 1.0f) < 0.0f);
+    }
+}
+
+TEST_CASE("change detector skips the readings a rearm makes stale") {
+    ChangeDetector detector{};
+    Random random{ 3 };
+    run(detector, random, 80.0, 3.0, 5.0f);
+
+    // What our own resolution change did to the signal isn't a scene change
+    detector.rearm();
+    CHECK(run(detector, random, 60.0, 3.0, 10.0f) < 0.0f);
+}
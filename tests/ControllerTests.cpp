@@ -0,0 +1,349 @@
+#include <algorithm>
+
+#include "autoscaler/Controller.hpp"
+#include "autoscaler/Pipeline.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+Decision run(Controller& controller, int usage, int frames) {
+    Decision last{};
+
+    for (int i = 0; i < frames; ++i) {
+        last = controller.update({ 1.0f / 90.0f, usage });
+    }
+
+    return last;
+}
+
+struct FixedSensor : Sensor {
+    int usage{ -1 };
+    int read_usage() override { return usage; }
+};
+
+struct RecordingActuator : Actuator {
+    int applied{ 0 };
+    int last{ 0 };
+    void apply(int screen_percentage) override { ++applied; last = screen_percentage; }
+};
+}
+
+TEST_CASE("controller increases after increaseframesrequired frames under the lower bound") {
+    Controller controller{ Settings{}, 50 };
+
+    // needs strictly more than increaseframesrequired consecutive frames
+    CHECK(run(controller, 70, 20).action == Action::None);
+    CHECK(controller.screen_percentage() == 50);
+
+    const auto decision = controller.update({ 1.0f / 90.0f, 70 });
+    CHECK(decision.action == Action::Increase);
+    CHECK(decision.screen_percentage == 51);
+    CHECK_NEAR(decision.seconds_since_last, 21.0f / 90.0f, 1e-4);
+}
+
+TEST_CASE("controller decreases after decreaseframesrequired frames over the upper bound") {
+    Controller controller{ Settings{}, 50 };
+
+    run(controller, 99, 11);
+    CHECK(controller.screen_percentage() == 48);
+}
+
+TEST_CASE("a single in-band frame restarts the count") {
+    Controller controller{ Settings{}, 50 };
+
+    run(controller, 70, 15);
+    run(controller, 85, 1);
+    run(controller, 70, 15);
+    CHECK(controller.screen_percentage() == 50);
+}
+
+TEST_CASE("a time window tolerates a stray in-band frame") {
+    Settings settings{};
+    settings.increasewindowms = 250;
+    settings.windowshare = 90;
+
+    Controller controller{ settings, 50 };
+
+    // 0.25 s is 22.5 frames at 90 Hz
+    run(controller, 70, 15);
+    run(controller, 85, 1);
+    run(controller, 70, 6);
+    CHECK(controller.screen_percentage() == 50);
+
+    run(controller, 70, 1);
+    CHECK(controller.screen_percentage() == 51);
+
+    // The window starts over after a change
+    run(controller, 70, 21);
+    CHECK(controller.screen_percentage() == 51);
+}
+
+TEST_CASE("a time window needs most of its time out of the band") {
+    Settings settings{};
+    settings.decreasewindowms = 250;
+    settings.windowshare = 90;
+
+    Controller controller{ settings, 50 };
+
+    // One in-band frame in four keeps the share at 75%
+    for (int i = 0; i < 40; ++i) {
+        run(controller, 99, 3);
+        run(controller, 85, 1);
+    }
+
+    CHECK(controller.screen_percentage() == 50);
+}
+
+TEST_CASE("a time window longer than the ring holds still fires at a high tick rate") {
+    Settings settings{};
+    settings.decreasewindowms = MAX_WINDOW_MS;
+
+    Controller controller{ settings, 50 };
+
+    // 1024 readings cover under 4.3 s at 240 Hz
+    for (int i = 0; i < 1100; ++i) {
+        controller.update({ 1.0f / 240.0f, 99 });
+    }
+
+    CHECK(controller.screen_percentage() < 50);
+}
+
+TEST_CASE("a tail of missed frames counts as over the band") {
+    Settings settings{};
+    settings.tailpercentile = 99;
+
+    Controller tail{ settings, 60 };
+
+    // Counting missed refreshes would catch these as well
+    Settings usage_only{};
+    usage_only.missedframes = 0;
+    Controller average{ usage_only, 60 };
+
+    // Usage sits inside the band while 3% of frames take two refresh intervals
+    for (int i = 0; i < 400; ++i) {
+        const auto delta = i % 100 < 3 ? 2.0f / 90.0f : 1.0f / 90.0f;
+        tail.update({ delta, 85 });
+        average.update({ delta, 85 });
+    }
+
+    CHECK(tail.screen_percentage() < 60);
+    CHECK(average.screen_percentage() == 60);
+}
+
+TEST_CASE("a tail within the refresh leaves the controller alone") {
+    Settings settings{};
+    settings.tailpercentile = 99;
+
+    Controller controller{ settings, 60 };
+
+    // Under 1% of frames missed
+    for (int i = 0; i < 1000; ++i) {
+        const auto decision = controller.update({ i % 250 == 0 ? 2.0f / 90.0f : 1.0f / 90.0f, 85 });
+        CHECK(decision.band == Band::Inside);
+    }
+
+    CHECK(controller.screen_percentage() == 60);
+}
+
+TEST_CASE("without a sensor missed refreshes alone take the resolution down") {
+    FixedSensor sensor{};
+    RecordingActuator actuator{};
+    Controller controller{ Settings{}, 80 };
+    Pipeline pipeline{ sensor, controller, actuator };
+
+    for (int i = 0; i < 180; ++i) {
+        pipeline.tick(1.0f / 90.0f);
+    }
+
+    CHECK(actuator.applied == 0);
+
+    // Every frame takes two intervals. One step as soon as a few are missed, then one per second.
+    for (int i = 0; i < 45; ++i) {
+        pipeline.tick(2.0f / 90.0f);
+    }
+
+    CHECK(actuator.applied == 1);
+    CHECK(actuator.last == 80 - Settings{}.decreaseresamount);
+
+    for (int i = 0; i < 45; ++i) {
+        pipeline.tick(2.0f / 90.0f);
+    }
+
+    CHECK(actuator.applied == 2);
+    CHECK(actuator.last == 80 - 2 * Settings{}.decreaseresamount);
+}
+
+TEST_CASE("without a sensor a cinematic cadence no console variable reports isn't taken for a frame cap") {
+    FixedSensor sensor{};
+    RecordingActuator actuator{};
+    Controller controller{ Settings{}, 80 };
+    Pipeline pipeline{ sensor, controller, actuator };
+
+    for (int i = 0; i < 180; ++i) {
+        pipeline.tick(1.0f / 90.0f);
+    }
+
+    // Every frame takes three intervals. With no GPU time to go by, that's the GPU, not a cap.
+    auto capped = false;
+    for (int i = 0; i < 90; ++i) {
+        capped = pipeline.tick(3.0f / 90.0f).capped || capped;
+    }
+
+    CHECK(!capped);
+    CHECK(actuator.applied >= 2);
+    CHECK(actuator.last < 80 - Settings{}.decreaseresamount);
+}
+
+TEST_CASE("without a sensor a cap t.MaxFPS reports holds the resolution") {
+    FixedSensor sensor{};
+    RecordingActuator actuator{};
+    Controller controller{ Settings{}, 80 };
+    controller.set_engine_caps(30.0f, 0);
+    Pipeline pipeline{ sensor, controller, actuator };
+
+    for (int i = 0; i < 180; ++i) {
+        pipeline.tick(1.0f / 90.0f);
+    }
+
+    // A minute of frames held to three intervals
+    auto capped = false;
+    for (int i = 0; i < 30 * 60; ++i) {
+        capped = pipeline.tick(3.0f / 90.0f).capped;
+    }
+
+    CHECK(capped);
+    CHECK(actuator.applied == 0);
+    CHECK(controller.screen_percentage() == 80);
+}
+
+TEST_CASE("the cascade trims within frames of missed refreshes and recovers in one change") {
+    Settings settings{};
+    settings.controller = "cascade";
+
+    Controller controller{ settings, 80 };
+    run(controller, 87, 90);
+    CHECK(controller.screen_percentage() == 80);
+
+    // Usage hasn't caught up yet, the deltas already say two frames missed
+    controller.update({ 2.0f / 90.0f, 87 });
+    const auto decision = controller.update({ 2.0f / 90.0f, 87 });
+    CHECK(decision.action == Action::Decrease);
+    CHECK(controller.screen_percentage() == 80 - settings.innerstep);
+
+    // All of it back after innerrecoveryms without a miss, not before
+    run(controller, 87, 90 * settings.innerrecoveryms / 1000 - 1);
+    CHECK(controller.screen_percentage() == 80 - settings.innerstep);
+    run(controller, 87, 2);
+    CHECK(controller.screen_percentage() == 80);
+}
+
+TEST_CASE("the cascade doesn't ratchet down on occasional missed refreshes") {
+    Settings settings{};
+    settings.controller = "cascade";
+
+    // Usage in the band and two missed refreshes every 6 s: each trim comes back in full, oscillation
+    // damping included
+    Controller controller{ settings, 80 };
+    int lowest = 80;
+
+    for (int burst = 0; burst < 20; ++burst) {
+        run(controller, 87, 90 * 6);
+        controller.update({ 2.0f / 90.0f, 87 });
+        controller.update({ 2.0f / 90.0f, 87 });
+        lowest = std::min(lowest, controller.screen_percentage());
+    }
+
+    run(controller, 87, 90 * 6);
+    CHECK(lowest == 80 - settings.innerstep);
+    CHECK(controller.screen_percentage() == 80);
+}
+
+TEST_CASE("the cascade trim is bounded") {
+    Settings settings{};
+    settings.controller = "cascade";
+
+    settings.changedetection = false;
+
+    Controller controller{ settings, 80 };
+    run(controller, 87, 90);
+
+    // Every frame misses while GPU time stays in the band, so only the inner loop acts
+    for (int i = 0; i < 40; ++i) {
+        controller.update({ 2.0f / 90.0f, 43 });
+    }
+
+    CHECK(controller.screen_percentage() == 80 - settings.innermaxtrim);
+}
+
+TEST_CASE("screen percentage stays inside the configured limits") {
+    Settings settings{};
+    settings.minscreenpercentage = 40;
+    settings.maxscreenpercentage = 60;
+    settings.increaseresamount = 7;
+    settings.decreaseresamount = 7;
+
+    Controller controller{ settings, 58 };
+    run(controller, 10, 100);
+    CHECK(controller.screen_percentage() == 60);
+
+    run(controller, 99, 100);
+    CHECK(controller.screen_percentage() == 40);
+
+    settings.minscreenpercentage = 45;
+    controller.set_settings(settings);
+    CHECK(controller.update({ 0.01f, 85 }).screen_percentage == 45);
+}
+
+TEST_CASE("missing readings leave the screen percentage alone") {
+    Controller controller{ Settings{}, 50 };
+    const auto decision = run(controller, -1, 100);
+
+    CHECK(decision.action == Action::None);
+    CHECK(decision.screen_percentage == 50);
+}
+
+TEST_CASE("pipeline only drives the actuator when the sensor has a reading") {
+    FixedSensor sensor{};
+    RecordingActuator actuator{};
+    Controller controller{ Settings{}, 50 };
+    Pipeline pipeline{ sensor, controller, actuator };
+
+    pipeline.tick(0.01f);
+    CHECK(actuator.applied == 0);
+
+    sensor.usage = 99;
+    for (int i = 0; i < 11; ++i) {
+        pipeline.tick(0.01f);
+    }
+
+    CHECK(actuator.applied == 11);
+    CHECK(actuator.last == 48);
+}
+
+TEST_CASE("a cost table lets the controller jump to the middle of the band") {
+    CostTable table{};
+    table.points = { { 50, 4.0 }, { 70, 8.0 }, { 90, 12.0 } };
+
+    Settings settings{};
+    settings.usagelowerbound = 80;
+    settings.usageupperbound = 90;
+
+    Controller controller{ settings, 50 };
+    controller.set_cost_table(table);
+
+    // 4 ms at 50% is 40% usage, so the middle of the band is about 8.5 ms
+    const auto up = run(controller, 40, 21);
+    CHECK(up.action == Action::Increase);
+    CHECK(up.screen_percentage == 72);
+
+    // 8.4 ms at 99% usage puts the middle of the band at about 7.2 ms
+    const auto down = run(controller, 99, 11);
+    CHECK(down.action == Action::Decrease);
+    CHECK(down.screen_percentage == 66);
+
+    settings.usecalibration = false;
+    controller.set_settings(settings);
+    CHECK(run(controller, 99, 11).screen_percentage == 64);
+}
@@ -0,0 +1,35 @@
+#include "autoscaler/CostModel.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("cost model learns fixed and per-pixel cost from resolution changes") {
+    CostModel model{};
+
+    for (int i = 0; i < 200; ++i) {
+        const auto pixels = (i / 20) % 2 == 0 ? 0.5 : 0.8;
+        model.add(pixels, 1.5 + 10.0 * pixels);
+    }
+
+    CHECK_NEAR(model.fixed(), 1.5, 0.1);
+    CHECK_NEAR(model.per_pixel(), 10.0, 0.2);
+    CHECK_NEAR(model.predict(1.0), 11.5, 0.1);
+}
+
+TEST_CASE("a scene change at one resolution keeps the shape of the curve") {
+    CostModel model{};
+
+    for (int i = 0; i < 200; ++i) {
+        const auto pixels = (i / 20) % 2 == 0 ? 0.5 : 0.8;
+        model.add(pixels, 1.5 + 10.0 * pixels);
+    }
+
+    // the scene gets half as heavy again while the resolution holds
+    for (int i = 0; i < 500; ++i) {
+        model.add(0.8, 1.5 * (1.5 + 10.0 * 0.8));
+    }
+
+    CHECK_NEAR(model.predict(0.8), 14.25, 0.1);
+    CHECK_NEAR(model.fixed() / model.per_pixel(), 0.15, 0.02);
+}
@@ -0,0 +1,85 @@
+#include "autoscaler/FrameCap.hpp"
+#include "autoscaler/Random.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+constexpr double REFRESH_MS = 1000.0 / 90.0;
+
+// Feeds seconds of frames taking the given number of 90 Hz intervals, returns whether the last one was capped
+bool feed(FrameCapDetector& detector, Random& random, double seconds, int intervals) {
+    auto capped = false;
+
+    for (auto time = 0.0; time < seconds; time += intervals * REFRESH_MS / 1000.0) {
+        capped = detector.add(static_cast<float>((intervals * REFRESH_MS + 0.15 * random.gaussian()) / 1000.0), REFRESH_MS);
+    }
+
+    return capped;
+}
+}
+
+TEST_CASE("a cutscene locked to 30 fps is a frame cap") {
+    FrameCapDetector detector{};
+    Random random{ 1 };
+
+    CHECK(!feed(detector, random, 2.0, 1));
+    CHECK(feed(detector, random, 2.0, 3));
+    CHECK_NEAR(detector.cap_ms(), 1000.0 / 30.0, 0.01);
+    CHECK(!detector.reported());
+}
+
+TEST_CASE("a cap the console variables report holds from the first frame held to it") {
+    FrameCapDetector detector{};
+    Random random{ 5 };
+    detector.set_engine_caps(30.0f, 0);
+
+    CHECK(!feed(detector, random, 2.0, 1));
+    CHECK(detector.add(static_cast<float>(3 * REFRESH_MS / 1000.0), REFRESH_MS));
+    CHECK(detector.reported());
+}
+
+TEST_CASE("t.MaxFPS caps frames at rates no cutscene uses") {
+    FrameCapDetector detector{};
+    Random random{ 2 };
+
+    // Two 90 Hz intervals, 45 fps
+    CHECK(!feed(detector, random, 2.0, 2));
+
+    detector.set_engine_caps(45.0f, 0);
+    CHECK(feed(detector, random, 2.0, 2));
+
+    detector.set_engine_caps(0.0f, 2);
+    CHECK(feed(detector, random, 2.0, 2));
+}
+
+TEST_CASE("frames that miss the refresh now and then aren't capped") {
+    FrameCapDetector detector{};
+    Random random{ 3 };
+    auto capped = false;
+
+    // Averages 30 fps, but stutters rather than being held, and makes the refresh whenever it can
+    for (int i = 0; i < 300; ++i) {
+        const auto intervals = i % 2 == 0 ? 1 : 5;
+        capped = detector.add(static_cast<float>((intervals * REFRESH_MS + 0.15 * random.gaussian()) / 1000.0), REFRESH_MS);
+    }
+
+    CHECK(!capped);
+}
+
+TEST_CASE("a cap ends as soon as frames make the refresh again") {
+    FrameCapDetector detector{};
+    Random random{ 4 };
+
+    CHECK(feed(detector, random, 2.0, 3));
+    CHECK(!feed(detector, random, 0.2, 1));
+}
+
+TEST_CASE("nothing is capped while the refresh interval isn't known") {
+    FrameCapDetector detector{};
+
+    for (int i = 0; i < 120; ++i) {
+        CHECK(!detector.add(1.0f / 30.0f, 0.0));
+    }
+}
@@ -0,0 +1,82 @@
+#include "autoscaler/FramePacing.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+constexpr double INTERVAL_MS = 1000.0 / 90.0;
+
+void feed(PacingAnalyzer& pacing, int intervals) {
+    const auto delta = static_cast<float>(intervals * INTERVAL_MS / 1000.0);
+    pacing.add(delta, refresh_intervals(delta, INTERVAL_MS));
+}
+}
+
+TEST_CASE("steady frames have no spread and no judder") {
+    PacingAnalyzer pacing{};
+
+    for (int i = 0; i < 100; ++i) {
+        feed(pacing, 1);
+    }
+
+    const auto stats = pacing.session();
+    CHECK(stats.frames == 100);
+    CHECK(stats.intervals[0] == 100);
+    CHECK_NEAR(stats.mean_ms, INTERVAL_MS, 1e-3);
+    CHECK_NEAR(stats.stddev_ms, 0.0, 1e-3);
+    CHECK(stats.judder == 0.0);
+}
+
+TEST_CASE("alternating cadence judders at the same average as a steady half rate") {
+    PacingAnalyzer alternating{};
+    PacingAnalyzer halved{};
+
+    for (int i = 0; i < 100; ++i) {
+        feed(alternating, 1 + i % 2);
+        feed(halved, 2);
+    }
+
+    CHECK_NEAR(alternating.session().judder, 100.0, 1e-9);
+    CHECK(alternating.session().intervals[1] == 50);
+    CHECK(halved.session().judder == 0.0);
+    CHECK(halved.session().intervals[1] == 100);
+}
+
+TEST_CASE("stalls are counted and the longest one kept") {
+    PacingAnalyzer pacing{};
+
+    for (int i = 0; i < 50; ++i) {
+        feed(pacing, i == 20 ? 7 : 1);
+    }
+
+    const auto stats = pacing.session();
+    CHECK(stats.intervals[2] == 1);
+    CHECK_NEAR(stats.longest_ms, 7 * INTERVAL_MS, 1e-3);
+    CHECK(stats.stddev_ms > 0.0);
+}
+
+TEST_CASE("recent pacing only covers the last frames") {
+    PacingAnalyzer pacing{};
+
+    for (size_t i = 0; i < PacingAnalyzer::HISTORY; ++i) {
+        feed(pacing, 2);
+    }
+
+    for (size_t i = 0; i < PacingAnalyzer::HISTORY; ++i) {
+        feed(pacing, 1);
+    }
+
+    CHECK(pacing.recent().intervals[0] == static_cast<int>(PacingAnalyzer::HISTORY));
+    CHECK(pacing.recent().intervals[1] == 0);
+    CHECK(pacing.session().intervals[1] == static_cast<int>(PacingAnalyzer::HISTORY));
+
+    // The ring holds the newest frame just before the offset
+    const auto newest = (pacing.history_offset() + PacingAnalyzer::HISTORY - 1) % PacingAnalyzer::HISTORY;
+    CHECK_NEAR(pacing.history()[newest], INTERVAL_MS, 1e-3);
+}
+
+TEST_CASE("without a known refresh every frame is one interval") {
+    CHECK(refresh_intervals(0.05f, 0.0) == 1);
+    CHECK(refresh_intervals(0.0225f, INTERVAL_MS) == 2);
+}
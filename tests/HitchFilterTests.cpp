@@ -0,0 +1,75 @@
+#include "autoscaler/HitchFilter.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+constexpr float FRAME = 1.0f / 90.0f;
+
+void settle(HitchFilter& filter, int usage) {
+    for (int i = 0; i < 90; ++i) {
+        filter.filter(FRAME, usage, 10.0f);
+    }
+}
+}
+
+TEST_CASE("an isolated long frame is replaced by the median") {
+    HitchFilter filter{};
+    settle(filter, 80);
+
+    const auto hitch = filter.filter(0.05f, 80, 10.0f);
+    CHECK(hitch.hitch == Hitch::Frame);
+    CHECK_NEAR(hitch.delta, FRAME, 1e-5);
+    CHECK(hitch.usage == 80);
+
+    // A missed refresh is real overload and goes through
+    const auto missed = filter.filter(2.0f * FRAME, 80, 10.0f);
+    CHECK(missed.hitch == Hitch::None);
+    CHECK_NEAR(missed.delta, 2.0f * FRAME, 1e-6);
+}
+
+TEST_CASE("slow frames that persist are not hitches") {
+    HitchFilter filter{};
+    settle(filter, 80);
+
+    int hitches = 0;
+
+    for (int i = 0; i < 10; ++i) {
+        hitches += filter.filter(0.05f, 80, 10.0f).hitch == Hitch::Frame ? 1 : 0;
+    }
+
+    CHECK(hitches == 3);
+    CHECK_NEAR(filter.filter(0.05f, 80, 10.0f).delta, 0.05f, 1e-6);
+}
+
+TEST_CASE("a short usage spike is held back and a lasting one passes") {
+    HitchFilter filter{};
+    settle(filter, 70);
+
+    // About one NVML sample's worth
+    for (int i = 0; i < 15; ++i) {
+        const auto result = filter.filter(FRAME, 98, 10.0f);
+        CHECK(result.usage == -1);
+        CHECK(result.hitch == Hitch::Usage);
+    }
+
+    CHECK(filter.filter(FRAME, 70, 10.0f).usage == 70);
+
+    // Held for at most HITCH_USAGE_SECONDS, after that the new level is believed
+    int held = 0;
+
+    for (int i = 0; i < 90; ++i) {
+        held += filter.filter(FRAME, 98, 10.0f).usage == -1 ? 1 : 0;
+    }
+
+    CHECK(held > 15);
+    CHECK(held < 30);
+}
+
+TEST_CASE("usage rising right after a change is never held back") {
+    HitchFilter filter{};
+    settle(filter, 70);
+
+    CHECK(filter.filter(FRAME, 98, 0.2f).usage == 98);
+}
@@ -0,0 +1,25 @@
+#include <cstdio>
+#include <cstring>
+
+#include "Test.hpp"
+
+// Runs every registered case, or only those whose name contains argv[1]
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : nullptr;
+    int run = 0;
+
+    for (const auto& c : test::cases()) {
+        if (filter != nullptr && std::strstr(c.name, filter) == nullptr) {
+            continue;
+        }
+
+        const auto before = test::failures();
+        c.fn();
+        ++run;
+
+        std::printf("%s %s\n", test::failures() == before ? "[ OK ]" : "[FAIL]", c.name);
+    }
+
+    std::printf("%d cases, %d failed checks\n", run, test::failures());
+    return test::failures() == 0 ? 0 : 1;
+}
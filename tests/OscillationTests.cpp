@@ -0,0 +1,72 @@
+#include "autoscaler/Oscillation.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+// Up one, down two, every few seconds, the cycle the default steps fall into
+void cycle(OscillationDetector& detector, int times) {
+    for (int i = 0; i < times; ++i) {
+        detector.tick(2.0f);
+        detector.record(true, 70, 71);
+        detector.tick(2.0f);
+        detector.record(false, 71, 69);
+        detector.tick(2.0f);
+        detector.record(true, 69, 70);
+    }
+}
+}
+
+TEST_CASE("changes in one direction aren't a cycle") {
+    OscillationDetector detector{};
+
+    for (int i = 0; i < 20; ++i) {
+        detector.tick(1.0f);
+        CHECK(!detector.record(true, 50 + i, 51 + i));
+    }
+
+    CHECK(detector.level() == 0);
+    CHECK(detector.cycles() == 0);
+}
+
+TEST_CASE("a recurring up and down pattern raises the damping and then pins") {
+    OscillationDetector detector{};
+
+    cycle(detector, 1);
+    CHECK(detector.level() == 0);
+
+    cycle(detector, 1);
+    CHECK(detector.level() == 1);
+    CHECK(detector.ceiling() == -1);
+
+    cycle(detector, 2);
+    CHECK(detector.level() == 2);
+    CHECK(detector.ceiling() == 69);
+    CHECK(detector.cycles() == 4);
+}
+
+TEST_CASE("damping relaxes a level per quiet period") {
+    OscillationDetector detector{};
+    cycle(detector, 4);
+    CHECK(detector.level() == 2);
+
+    detector.tick(31.0f);
+    CHECK(detector.level() == 1);
+    CHECK(detector.ceiling() == -1);
+
+    detector.tick(31.0f);
+    CHECK(detector.level() == 0);
+}
+
+TEST_CASE("reversals far apart are the scene, not a cycle") {
+    OscillationDetector detector{};
+
+    for (int i = 0; i < 10; ++i) {
+        detector.tick(15.0f);
+        detector.record(i % 2 == 0, 70, 72);
+    }
+
+    CHECK(detector.level() == 0);
+    CHECK(detector.cycles() == 4);
+}
@@ -0,0 +1,65 @@
+#include <random>
+
+#include "autoscaler/Quantile.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("p2 quantile is exact over the first values") {
+    P2Quantile median{ 0.5 };
+    CHECK_NEAR(median.value(), 0.0, 1e-9);
+
+    median.add(30.0);
+    median.add(10.0);
+    median.add(20.0);
+    CHECK(median.count() == 3);
+    CHECK_NEAR(median.value(), 20.0, 1e-9);
+}
+
+TEST_CASE("p2 quantile tracks tail percentiles of a stream") {
+    std::mt19937 rng{ 7 };
+    std::uniform_real_distribution<double> uniform{ 0.0, 100.0 };
+    P2Quantile p95{ 0.95 };
+    P2Quantile p99{ 0.99 };
+
+    for (int i = 0; i < 20000; ++i) {
+        const auto value = uniform(rng);
+        p95.add(value);
+        p99.add(value);
+    }
+
+    CHECK_NEAR(p95.value(), 95.0, 1.0);
+    CHECK_NEAR(p99.value(), 99.0, 0.5);
+}
+
+TEST_CASE("p2 quantile finds a tail of missed frames") {
+    P2Quantile p99{ 0.99 };
+
+    // 3% of frames take two refresh intervals
+    for (int i = 0; i < 3000; ++i) {
+        p99.add(i % 100 < 3 ? 22.2 : 11.1);
+    }
+
+    CHECK(p99.value() > 20.0);
+}
+
+TEST_CASE("rolling quantile forgets values older than its span") {
+    RollingQuantile p95{ 0.95, 1.0f };
+
+    for (int i = 0; i < 180; ++i) {
+        p95.push(1.0f / 90.0f, 22.2);
+    }
+
+    CHECK_NEAR(p95.value(), 22.2, 1e-6);
+
+    for (int i = 0; i < 180; ++i) {
+        p95.push(1.0f / 90.0f, 11.1);
+    }
+
+    CHECK_NEAR(p95.value(), 11.1, 1e-6);
+
+    // The estimate always has between half a span and a span behind it
+    CHECK(p95.count() >= 45);
+    CHECK(p95.count() <= 90);
+}
@@ -0,0 +1,65 @@
+#include "autoscaler/Replay.hpp"
+
+#include "SimulatedTrace.hpp"
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("session stats weight resolution by time") {
+    SessionStatsBuilder builder{ 82, 92 };
+
+    builder.add(9.0, 85, 100, Action::None, 0);
+    builder.add(1.0, 95, 50, Action::Decrease, 2);
+
+    const auto stats = builder.finish();
+    CHECK_NEAR(stats.seconds, 10.0, 1e-9);
+    CHECK_NEAR(stats.mean_screen_percentage, 95.0, 1e-9);
+    CHECK_NEAR(stats.p5_screen_percentage, 50.0, 1e-9);
+    CHECK_NEAR(stats.time_in_band, 0.9, 1e-9);
+    CHECK(stats.missed_frames == 2);
+    CHECK(stats.changes == 1);
+    CHECK(stats.pacing.intervals[0] == 1);
+    CHECK(stats.pacing.intervals[2] == 1);
+    CHECK_NEAR(stats.pacing.longest_ms, 9000.0, 1e-6);
+}
+
+TEST_CASE("refresh interval comes from the most common delta") {
+    const auto data = simulated_trace(PlantParams{}, Settings{}, 30.0);
+    CHECK_NEAR(estimate_refresh_interval(data.data(), data.size()), 1.0 / 90.0, 1e-4);
+}
+
+TEST_CASE("replaying with the recorded settings roughly reproduces the session") {
+    const auto data = simulated_trace(PlantParams{}, Settings{}, 300.0);
+    const auto result = replay_trace(data.data(), data.size(), Settings{}, Settings{});
+
+    CHECK(result.recorded.frames == result.replayed.frames);
+    CHECK_NEAR(result.replayed.mean_screen_percentage, result.recorded.mean_screen_percentage, 5.0);
+}
+
+TEST_CASE("replaying with a lower band settles at a lower resolution") {
+    const auto data = simulated_trace(PlantParams{}, Settings{}, 300.0);
+
+    Settings lower{};
+    lower.usagelowerbound = 60;
+    lower.usageupperbound = 70;
+
+    const auto result = replay_trace(data.data(), data.size(), lower, Settings{});
+    CHECK(result.replayed.mean_screen_percentage < result.recorded.mean_screen_percentage - 5.0);
+}
+
+TEST_CASE("every column is scored against the band the session was recorded with") {
+    const auto data = simulated_trace(PlantParams{}, Settings{}, 300.0);
+
+    Settings lower{};
+    lower.usagelowerbound = 60;
+    lower.usageupperbound = 70;
+
+    const auto same = replay_trace(data.data(), data.size(), Settings{}, Settings{});
+    const auto other = replay_trace(data.data(), data.size(), lower, Settings{});
+
+    // The recorded column doesn't depend on which settings it's compared with, and settling in another
+    // band counts as outside the recorded one
+    CHECK_NEAR(other.recorded.time_in_band, same.recorded.time_in_band, 1e-9);
+    CHECK(same.recorded.time_in_band > 0.5);
+    CHECK(other.replayed.time_in_band < 0.2);
+}
@@ -0,0 +1,99 @@
+#include "autoscaler/Settings.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("partial or mistyped config only changes valid keys") {
+    Settings settings{};
+    const auto j = nlohmann::json::parse(R"({ "usagelowerbound": 75, "usageupperbound": "high", "maxscreenpercentage": 120 })");
+
+    CHECK(apply_settings(j, settings));
+    CHECK(settings.usagelowerbound == 75);
+    CHECK(settings.usageupperbound == 92);
+    CHECK(settings.maxscreenpercentage == 120);
+}
+
+TEST_CASE("settings round trip through json") {
+    Settings settings{};
+    settings.increaseframesrequired = 33;
+    settings.minscreenpercentage = 35;
+    settings.raiseduringcaps = true;
+
+    Settings loaded{};
+    CHECK(apply_settings(settings_to_json(settings), loaded));
+    CHECK(loaded.increaseframesrequired == 33);
+    CHECK(loaded.minscreenpercentage == 35);
+    CHECK(loaded.raiseduringcaps);
+}
+
+TEST_CASE("a hand edited band or range out of order is put right") {
+    Settings settings{};
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "usagelowerbound": 90, "usageupperbound": 80, "minscreenpercentage": 80, "maxscreenpercentage": 50, "increaseresamount": 0 })"), settings));
+    CHECK(settings.usagelowerbound == 90);
+    CHECK(settings.usageupperbound == 95);
+    CHECK(settings.minscreenpercentage == 80);
+    CHECK(settings.maxscreenpercentage == 80);
+    CHECK(settings.increaseresamount == 1);
+
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "usagelowerbound": 20, "usageupperbound": 150, "minscreenpercentage": 1 })"), settings));
+    CHECK(settings.usagelowerbound == 60);
+    CHECK(settings.usageupperbound == 95);
+    CHECK(settings.minscreenpercentage == 10);
+
+    // A run of 1000 missed frames would never come, turning the cascade's inner loop off
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "innerframes": 1000, "innerrecoveryms": 60000, "outertimems": 100000 })"), settings));
+    CHECK(settings.innerframes == 10);
+    CHECK(settings.innerrecoveryms == 5000);
+    CHECK(settings.outertimems == 20000);
+
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "innerframes": 0, "innerrecoveryms": 0, "outertimems": -1 })"), settings));
+    CHECK(settings.innerframes == 1);
+    CHECK(settings.innerrecoveryms == 100);
+    CHECK(settings.outertimems == 100);
+}
+
+TEST_CASE("windows are clamped to what the controller can hold") {
+    Settings settings{};
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "increasewindowms": 60000, "decreasewindowms": -5, "windowshare": 20 })"), settings));
+    CHECK(settings.increasewindowms == MAX_WINDOW_MS);
+    CHECK(settings.decreasewindowms == 0);
+    CHECK(settings.windowshare == 50);
+}
+
+TEST_CASE("unknown sensors fall back to nvml") {
+    Settings settings{};
+    CHECK(!apply_settings(nlohmann::json::parse(R"({ "sensor": "adl" })"), settings));
+    CHECK(settings.sensor == "nvml");
+}
+
+TEST_CASE("unknown controllers fall back to stepping") {
+    Settings settings{};
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "controller": "predictive" })"), settings));
+    CHECK(settings.controller == "predictive");
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "controller": "cascade" })"), settings));
+    CHECK(settings.controller == "cascade");
+    CHECK(!apply_settings(nlohmann::json::parse(R"({ "controller": "pid" })"), settings));
+    CHECK(settings.controller == "step");
+}
+
+TEST_CASE("only p95 and p99 can be targeted") {
+    Settings settings{};
+    CHECK(apply_settings(nlohmann::json::parse(R"({ "tailpercentile": 99 })"), settings));
+    CHECK(settings.tailpercentile == 99);
+    CHECK(!apply_settings(nlohmann::json::parse(R"({ "tailpercentile": 90 })"), settings));
+    CHECK(settings.tailpercentile == 0);
+}
+
+TEST_CASE("profile selection prefers a build specific match") {
+    const auto store = nlohmann::json::parse(R"({ "profiles": [
+        { "game": "Other.exe" },
+        { "game": "Game-Win64-Shipping.exe" },
+        { "game": "game-win64-shipping.exe", "uevr": "abc123" }
+    ] })");
+
+    CHECK(select_profile(store, "Game-Win64-Shipping.exe", "abc123def", "v1.05") == 2);
+    CHECK(select_profile(store, "Game-Win64-Shipping.exe", "fff", "v1.05") == 1);
+    CHECK(select_profile(store, "Missing.exe", "fff", "v1.05") == -1);
+    CHECK(select_profile(nlohmann::json::object(), "Game-Win64-Shipping.exe", "", "") == -1);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "autoscaler/Simulator.hpp"
+#include "autoscaler/Trace.hpp"
+
+// A simulator run encoded the way the plugin records its telemetry
+inline std::vector<std::uint8_t> simulated_trace(const autoscaler::PlantParams& params, const autoscaler::Settings& settings,
+    double seconds)
+{
+    using namespace autoscaler;
+
+    auto data = TraceEncoder::header();
+    TraceEncoder encoder{};
+
+    simulate(params, settings, seconds, 50, [&](const SimFrame& frame, const Decision& decision) {
+        TraceRecord record{};
+        record.time_us = static_cast<std::int64_t>(frame.time * 1'000'000.0);
+        record.delta_us = static_cast<std::int64_t>(frame.delta * 1'000'000.0);
+        record.usage = decision.usage;
+        record.band = decision.band;
+        record.action = decision.action;
+        record.screen_percentage = decision.screen_percentage;
+        encoder.encode(record, data);
+    });
+
+    return data;
+}
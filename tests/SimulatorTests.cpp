@@ -0,0 +1,345 @@
+#include <algorithm>
+
+#include "autoscaler/Simulator.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+// What a simulated run did from a point in it on
+struct Summary {
+    int changes{ 0 };
+    int missed{ 0 };  // refresh intervals missed
+    int lowest{ 1000 };
+    int highest{ 0 };
+    int last{ 0 };
+    int hitches{ 0 };
+    int changes_on_hitches{ 0 };
+    int scene_changes{ 0 };
+    int most_damping{ 0 };
+    double first_change{ -1.0 };
+    double first_scene_change{ -1.0 };
+};
+
+Summary summarize(const PlantParams& params, const Settings& settings, double seconds, int start, double from = 0.0) {
+    Summary summary{};
+    simulate(params, settings, seconds, start, [&](const SimFrame& frame, const Decision& decision) {
+        if (frame.time < from) {
+            return;
+        }
+
+        const auto changed = decision.action != Action::None;
+        if (changed && summary.first_change < 0.0) {
+            summary.first_change = frame.time;
+        }
+
+        if (decision.scene_change && summary.first_scene_change < 0.0) {
+            summary.first_scene_change = frame.time;
+        }
+
+        summary.changes += changed ? 1 : 0;
+        summary.missed += frame.intervals - 1;
+        summary.lowest = std::min(summary.lowest, frame.screen_percentage);
+        summary.highest = std::max(summary.highest, frame.screen_percentage);
+        summary.last = frame.screen_percentage;
+        summary.hitches += decision.hitch != Hitch::None ? 1 : 0;
+        summary.changes_on_hitches += decision.hitch != Hitch::None && changed ? 1 : 0;
+        summary.scene_changes += decision.scene_change ? 1 : 0;
+        summary.most_damping = std::max(summary.most_damping, decision.damping);
+    });
+    return summary;
+}
+}
+
+TEST_CASE("plant gpu cost scales with pixel count") {
+    PlantParams params{};
+    params.fixed_gpu_ms = 0.0;
+    params.gpu_ms_at_100 = 8.0;
+
+    const Plant plant{ params };
+    CHECK_NEAR(plant.gpu_ms(100, 1.0), 8.0, 1e-9);
+    CHECK_NEAR(plant.gpu_ms(50, 1.0), 2.0, 1e-9);
+    CHECK_NEAR(plant.gpu_ms(50, 2.0), 4.0, 1e-9);
+}
+
+TEST_CASE("plant misses refresh intervals when over budget") {
+    PlantParams params{};
+    params.noise = 0.0;
+    params.change_hitch_ms = 0.0;
+    params.gpu_ms_at_100 = 15.0;
+
+    Plant plant{ params, 100 };
+    const auto frame = plant.step();
+    CHECK(frame.intervals == 2);
+    CHECK_NEAR(frame.delta, 2.0 / 90.0, 1e-9);
+}
+
+TEST_CASE("sensor readings arrive after the sampling period and delay") {
+    PlantParams params{};
+    params.noise = 0.0;
+    params.gpu_ms_at_100 = 9.0;
+    params.sensor_delay_frames = 3;
+
+    Plant plant{ params, 100 };
+
+    // 15 frames fill the 1/6 s NVML window at 90 Hz, then the delay line holds it back 3 more
+    for (int i = 0; i < 17; ++i) {
+        CHECK(plant.step().usage == -1);
+    }
+
+    CHECK(plant.step().usage == 90);
+}
+
+TEST_CASE("simulation is deterministic for a seed") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 30.0, 1.6 } };
+
+    const auto a = simulate(params, Settings{}, 60.0);
+    const auto b = simulate(params, Settings{}, 60.0);
+    CHECK(a.frames == b.frames);
+    CHECK(a.changes == b.changes);
+    CHECK(a.mean_screen_percentage == b.mean_screen_percentage);
+}
+
+TEST_CASE("controller settles inside the usage band on a steady scene") {
+    PlantParams params{};
+
+    int last_usage = -1;
+    int last_screen_percentage = 0;
+    simulate(params, Settings{}, 120.0, 50, [&](const SimFrame& frame, const Decision&) {
+        last_usage = frame.usage;
+        last_screen_percentage = frame.screen_percentage;
+    });
+
+    CHECK(last_screen_percentage > 80);
+    CHECK(last_usage >= 75 && last_usage <= 95);
+}
+
+TEST_CASE("a scene transition is re-acquired within a couple of seconds") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 60.0, 1.6 } };
+
+    // Past one interval vsync hides the load from usage, so without it stepping alone never gets out
+    Settings settings{};
+    settings.missedframes = 0;
+
+    const auto run = summarize(params, settings, 90.0, 85);
+    CHECK(run.first_scene_change >= 60.0 && run.first_scene_change < 61.5);
+    CHECK(run.scene_changes <= 3);
+
+    CHECK(summarize(params, settings, 90.0, 85, 62.0).missed < 50);
+
+    // And it holds the level it found
+    const auto settled = summarize(params, settings, 90.0, 85, 65.0);
+    CHECK(settled.highest - settled.lowest <= 2);
+    CHECK(settled.last < 75);
+}
+
+TEST_CASE("a CPU-bound drop in load gets one jump up, not a climb") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 30.0, 1.0, 15.0 } };
+
+    // Room above so the jumps aren't just stopped by the limit
+    Settings settings{};
+    settings.controller = "cascade";
+    settings.maxscreenpercentage = 200;
+
+    // The GPU idles while the game thread holds frames back, a bigger resolution reads no busier for it
+    int scene_changes = 0;
+    int jumps = 0;
+    int largest = 0;
+    int previous = 85;
+    simulate(params, settings, 40.0, 85, [&](const SimFrame& frame, const Decision& decision) {
+        if (frame.time >= 30.0 && decision.action == Action::Increase) {
+            // The outer loop's own steps are 2 points
+            const auto step = decision.screen_percentage - previous;
+            jumps += step > 2 ? 1 : 0;
+            largest = std::max(largest, step);
+        }
+
+        scene_changes += frame.time >= 30.0 && decision.scene_change ? 1 : 0;
+        previous = decision.screen_percentage;
+    });
+
+    // No more than one predicted step
+    CHECK(scene_changes >= 1);
+    CHECK(jumps == 1);
+    CHECK(largest <= 20);
+}
+
+TEST_CASE("missed refreshes get stepping out of the vsync trap") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 60.0, 1.6 } };
+
+    // Without missedframes it climbs into the 90s, usage reads low once every frame takes two intervals
+    Settings settings{};
+    settings.changedetection = false;
+
+    const auto run = summarize(params, settings, 90.0, 85, 60.0);
+    CHECK(run.first_change >= 60.0 && run.first_change < 60.5);
+    CHECK(run.highest <= 85);
+    CHECK(run.last < 75);
+
+    CHECK(summarize(params, settings, 90.0, 85, 62.0).missed < 50);
+}
+
+TEST_CASE("damping breaks the cycle a noisy sensor drives the controller into") {
+    PlantParams params{};
+    params.noise = 0.05;
+    params.sensor_noise = 5.0;
+
+    const auto run = summarize(params, Settings{}, 300.0, 85);
+    CHECK(run.most_damping >= 2);
+
+    // Undamped it changes about 360 times in the last four minutes
+    const auto damped = summarize(params, Settings{}, 300.0, 85, 60.0);
+    CHECK(damped.changes < 90);
+    CHECK(damped.highest - damped.lowest <= 10);
+}
+
+TEST_CASE("predictive controller reaches the band in a few changes and stays there") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 60.0, 1.5 } };
+
+    Settings settings{};
+    settings.controller = "predictive";
+
+    int cold_start_changes = 0;
+    int spike_changes = 0;
+    int last_usage = -1;
+
+    const auto stats = simulate(params, settings, 120.0, 50, [&](const SimFrame& frame, const Decision& decision) {
+        if (decision.action != Action::None) {
+            ++(frame.time < 60.0 ? cold_start_changes : spike_changes);
+        }
+
+        last_usage = frame.usage;
+    });
+
+    // stepping by 1% takes 35 changes to get there from 50%
+    CHECK(cold_start_changes <= 6);
+    CHECK(spike_changes <= 6);
+    CHECK(last_usage >= 75 && last_usage <= 95);
+    CHECK(stats.missed_frames < stats.frames / 100);
+}
+
+TEST_CASE("probing controller finds the limit and then probes less and less") {
+    PlantParams params{};
+
+    Settings settings{};
+    settings.controller = "probe";
+
+    int early_changes = 0;
+    int late_changes = 0;
+    int last_screen_percentage = 0;
+
+    const auto stats = simulate(params, settings, 300.0, 50, [&](const SimFrame& frame, const Decision& decision) {
+        if (decision.action != Action::None) {
+            ++(frame.time < 60.0 ? early_changes : late_changes);
+        }
+
+        last_screen_percentage = frame.screen_percentage;
+    });
+
+    // the last 4 minutes see a handful of probes, each failure doubling the wait for the next
+    CHECK(late_changes <= 10);
+    CHECK(late_changes < early_changes);
+    CHECK(last_screen_percentage >= 82 && last_screen_percentage <= 90);
+    CHECK(stats.missed_frames < stats.frames / 100);
+}
+
+TEST_CASE("cascade settles in the band and a noisy sensor barely moves it") {
+    PlantParams params{};
+
+    Settings settings{};
+    settings.controller = "cascade";
+
+    int last_usage = 0;
+    const auto stats = simulate(params, settings, 60.0, 50, [&](const SimFrame& frame, const Decision&) {
+        last_usage = frame.usage;
+    });
+
+    CHECK(last_usage >= 75 && last_usage <= 95);
+    CHECK(stats.missed_frames < stats.frames / 100);
+
+    params.noise = 0.05;
+    params.sensor_noise = 5.0;
+
+    int changes = 0;
+    const auto noisy = simulate(params, settings, 120.0, 85, [&](const SimFrame&, const Decision& decision) {
+        changes += decision.action != Action::None ? 1 : 0;
+    });
+
+    CHECK(changes <= 10);
+    CHECK(noisy.missed_frames < noisy.frames / 100);
+}
+
+TEST_CASE("a cutscene's frame cap doesn't raise the resolution play resumes at") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 60.0, 1.0, 1000.0 / 30.0 }, { 120.0, 1.0 } };
+
+    // Over NVML's period the drop in usage arrives over a few readings. Read every frame it's instant, and
+    // the scene change detector fires well inside the second the cap takes to tell.
+    for (const auto sensor_period : { PlantParams{}.sensor_period, 1.0 / 90.0 }) {
+        params.sensor_period = sensor_period;
+
+        for (const auto* controller : { "step", "predictive", "probe", "cascade" }) {
+            Settings settings{};
+            settings.controller = controller;
+
+            int before = 0;
+            int during = 0;
+            int capped = 0;
+            int missed_after = 0;
+            simulate(params, settings, 180.0, 85, [&](const SimFrame& frame, const Decision& decision) {
+                if (frame.time < 60.0) {
+                    before = frame.screen_percentage;
+                }
+                else if (frame.time < 120.0) {
+                    during = std::max(during, frame.screen_percentage);
+                    capped += decision.capped ? 1 : 0;
+                }
+                else {
+                    missed_after += frame.intervals - 1;
+                }
+            });
+
+            // 30 fps for a minute, all but the second it takes to tell
+            CHECK(capped > 1700);
+            CHECK(during <= before + 1);
+            CHECK(missed_after < 30);
+        }
+    }
+}
+
+TEST_CASE("random hitches don't cost the probing controller resolution") {
+    PlantParams params{};
+    params.hitch_rate = 0.5;
+
+    Settings settings{};
+    settings.controller = "probe";
+
+    // Unfiltered, every hitch reads as an overload and it wanders down into the 70s
+    const auto run = summarize(params, settings, 120.0, 85, 10.0);
+    CHECK(run.hitches > 0);
+    CHECK(run.changes_on_hitches == 0);
+    CHECK(run.lowest >= 80);
+    CHECK(run.changes <= 12);
+}
+
+TEST_CASE("plant params round trip through json") {
+    PlantParams params{};
+    params.scene = { { 0.0, 1.0 }, { 10.0, 2.0 } };
+    params.ramp_scene = true;
+    params.cpu_ms = 12.5;
+
+    PlantParams loaded{};
+    CHECK(apply_plant_params(plant_params_to_json(params), loaded));
+    CHECK(loaded.scene.size() == 2);
+    CHECK(loaded.ramp_scene);
+    CHECK_NEAR(loaded.cpu_ms, 12.5, 1e-9);
+
+    const Plant plant{ loaded };
+    CHECK_NEAR(plant.scene_cost(5.0), 1.5, 1e-9);
+}
@@ -0,0 +1,44 @@
+#include "autoscaler/SystemId.hpp"
+
+#include "SimulatedTrace.hpp"
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("plant identification recovers the simulator's parameters") {
+    PlantParams truth{};
+    truth.gpu_ms_at_100 = 10.0;
+    truth.fixed_gpu_ms = 1.5;
+    truth.noise = 0.05;
+    truth.sensor_delay_frames = 4;
+    truth.change_hitch_ms = 6.0;
+    // scene changes keep the controller moving through a range of resolutions
+    truth.scene = { { 0.0, 1.0 }, { 120.0, 0.7 }, { 240.0, 1.3 }, { 360.0, 0.9 }, { 480.0, 1.1 } };
+
+    Settings settings{};
+
+    const auto data = simulated_trace(truth, settings, 600.0);
+
+    PlantIdentifier identifier{};
+    CHECK(identifier.add_trace(data.data(), data.size()));
+
+    const auto fit = identifier.fit();
+    CHECK(fit.readings > 1000);
+    CHECK_NEAR(fit.params.refresh_hz, 90.0, 0.1);
+    CHECK_NEAR(fit.params.sensor_period, 1.0 / 6.0, 0.01);
+    CHECK(fit.params.sensor_delay_frames == truth.sensor_delay_frames);
+    CHECK_NEAR(fit.params.gpu_ms_at_100, truth.gpu_ms_at_100, 0.5);
+    CHECK_NEAR(fit.params.fixed_gpu_ms, truth.fixed_gpu_ms, 0.3);
+    CHECK_NEAR(fit.params.noise, truth.noise, 0.015);
+    CHECK_NEAR(fit.params.change_hitch_ms, truth.change_hitch_ms, 2.0);
+
+    // the heavy stretch shows up in the scene
+    double cost_at_300 = 0.0;
+    for (const auto& segment : fit.params.scene) {
+        if (segment.start_seconds <= 300.0) {
+            cost_at_300 = segment.cost;
+        }
+    }
+
+    CHECK_NEAR(cost_at_300 * fit.params.gpu_ms_at_100, 1.3 * truth.gpu_ms_at_100, 0.5);
+}
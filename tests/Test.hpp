@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+// Just enough of a test harness to run the core on any machine without extra dependencies
+namespace test {
+struct Case {
+    const char* name;
+    std::function<void()> fn;
+};
+
+inline std::vector<Case>& cases() {
+    static std::vector<Case> s_cases{};
+    return s_cases;
+}
+
+inline int& failures() {
+    static int s_failures{ 0 };
+    return s_failures;
+}
+
+struct Register {
+    Register(const char* name, std::function<void()> fn) {
+        cases().push_back({ name, std::move(fn) });
+    }
+};
+}
+
+#define TEST_CONCAT_(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT_(a, b)
+
+#define TEST_CASE(name) \
+    static void TEST_CONCAT(test_fn_, __LINE__)(); \
+    static test::Register TEST_CONCAT(test_reg_, __LINE__){ name, TEST_CONCAT(test_fn_, __LINE__) }; \
+    static void TEST_CONCAT(test_fn_, __LINE__)()
+
+#define CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            std::printf("  %s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #expr); \
+            ++test::failures(); \
+        } \
+    } while (false)
+
+#define CHECK_NEAR(a, b, eps) CHECK(std::fabs(static_cast<double>(a) - static_cast<double>(b)) <= (eps))
@@ -0,0 +1,79 @@
+#include "autoscaler/TimeWindow.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("time window drops entries older than its span") {
+    TimeWindow<64> window{ 0.5f };
+
+    for (int i = 0; i < 20; ++i) {
+        window.push(0.1f, static_cast<float>(i));
+    }
+
+    // The oldest entry goes once the newer ones cover the span by themselves
+    CHECK(window.size() == 5);
+    CHECK_NEAR(window.seconds(), 0.5f, 1e-4);
+    CHECK_NEAR(window.median(1.0f), 17.0f, 1e-4);
+}
+
+TEST_CASE("time window drops the oldest entry when the ring is full") {
+    TimeWindow<8> window{ 10.0f };
+
+    for (int i = 0; i < 12; ++i) {
+        window.push(0.01f, static_cast<float>(i));
+    }
+
+    CHECK(window.size() == 8);
+    CHECK_NEAR(window.trimmed_mean(10.0f, 0.0f), 7.5f, 1e-4);
+}
+
+TEST_CASE("time window shares are weighted by time") {
+    TimeWindow<64> window{ 1.0f };
+    window.push(0.75f, 60.0f);
+    window.push(0.25f, 95.0f);
+
+    CHECK_NEAR(window.share_at_or_below(70.0f, 1.0f), 0.75f, 1e-4);
+    CHECK_NEAR(window.share_at_or_above(90.0f, 1.0f), 0.25f, 1e-4);
+
+    // Shorter spans only look at the newest entries
+    CHECK_NEAR(window.share_at_or_above(90.0f, 0.25f), 1.0f, 1e-4);
+}
+
+TEST_CASE("time window trimmed mean and median ignore outliers") {
+    TimeWindow<64> window{ 1.0f };
+
+    for (int i = 0; i < 9; ++i) {
+        window.push(0.1f, 70.0f);
+    }
+
+    window.push(0.1f, 100.0f);
+
+    CHECK_NEAR(window.median(1.0f), 70.0f, 1e-4);
+    CHECK_NEAR(window.trimmed_mean(1.0f, 0.1f), 70.0f, 1e-4);
+    CHECK_NEAR(window.trimmed_mean(1.0f, 0.0f), 73.0f, 1e-4);
+}
+
+TEST_CASE("time window sums the newest span") {
+    TimeWindow<64> window{ 2.0f };
+
+    for (int i = 0; i < 10; ++i) {
+        window.push(0.1f, 1.0f);
+    }
+
+    CHECK_NEAR(window.sum(0.5f), 5.0f, 1e-4);
+    CHECK_NEAR(window.sum(10.0f), 10.0f, 1e-4);
+}
+
+TEST_CASE("empty time window reports nothing") {
+    TimeWindow<16> window{};
+
+    CHECK(window.size() == 0);
+    CHECK_NEAR(window.median(1.0f), 0.0f, 1e-6);
+    CHECK_NEAR(window.share_at_or_below(100.0f, 1.0f), 0.0f, 1e-6);
+
+    window.push(0.1f, 50.0f);
+    window.clear();
+    CHECK(window.size() == 0);
+    CHECK_NEAR(window.seconds(), 0.0f, 1e-6);
+}
@@ -0,0 +1,191 @@
+#include <cstdio>
+#include <string>
+#include <thread>
+
+#include "autoscaler/SpscRing.hpp"
+#include "autoscaler/TelemetryRecorder.hpp"
+#include "autoscaler/Trace.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+TraceRecord make_record(int i) {
+    TraceRecord record{};
+    record.time_us = i * 11111;
+    record.delta_us = 11111 + (i % 3) * 11111;
+    record.usage = 80 + i % 15;
+    record.band = static_cast<Band>(i % 4);
+    record.action = static_cast<Action>(i % 3);
+    record.screen_percentage = 50 + i % 40;
+    record.frame_p95_us = 11111 + (i % 5) * 100;
+    record.frame_p99_us = 22222 - (i % 7) * 100;
+    record.hitch = static_cast<Hitch>(i % 3);
+    record.damping = i % 4;
+    record.missed = i % 3;
+    record.present_us = 11111 + (i % 2) * 11111;
+    record.capped = i % 5 == 0;
+    return record;
+}
+
+bool same(const TraceRecord& a, const TraceRecord& b) {
+    return a.time_us == b.time_us && a.delta_us == b.delta_us && a.usage == b.usage && a.band == b.band &&
+        a.action == b.action && a.screen_percentage == b.screen_percentage && a.frame_p95_us == b.frame_p95_us &&
+        a.frame_p99_us == b.frame_p99_us && a.hitch == b.hitch && a.damping == b.damping &&
+        a.missed == b.missed && a.present_us == b.present_us && a.capped == b.capped;
+}
+}
+
+TEST_CASE("trace records round trip through the encoder") {
+    auto data = TraceEncoder::header();
+    TraceEncoder encoder{};
+
+    for (int i = 0; i < 1000; ++i) {
+        encoder.encode(make_record(i), data);
+    }
+
+    TraceDecoder decoder{ data.data(), data.size() };
+    CHECK(decoder.valid());
+
+    TraceRecord record{};
+    int count = 0;
+    while (decoder.next(record)) {
+        CHECK(same(record, make_record(count)));
+        ++count;
+    }
+
+    CHECK(count == 1000);
+}
+
+TEST_CASE("delta encoding keeps steady ticks small") {
+    const auto header_size = TraceEncoder::header().size();
+    std::vector<std::uint8_t> data{};
+    TraceEncoder encoder{};
+
+    TraceRecord record{};
+    record.usage = 88;
+    record.band = Band::Inside;
+    record.screen_percentage = 70;
+    record.delta_us = 11111;
+    record.frame_p95_us = 11500;
+    record.frame_p99_us = 12000;
+
+    for (int i = 0; i < 1000; ++i) {
+        record.time_us += 11111;
+        encoder.encode(record, data);
+    }
+
+    // time and delta cost a few bytes, everything unchanged costs one
+    CHECK(data.size() < 1000 * 16);
+    CHECK(header_size < 160);
+}
+
+TEST_CASE("a truncated trace reads back up to the last whole record") {
+    auto data = TraceEncoder::header();
+    TraceEncoder encoder{};
+
+    for (int i = 0; i < 10; ++i) {
+        encoder.encode(make_record(i), data);
+    }
+
+    data.resize(data.size() - 2);
+
+    TraceDecoder decoder{ data.data(), data.size() };
+    TraceRecord record{};
+    int count = 0;
+    while (decoder.next(record)) {
+        ++count;
+    }
+
+    CHECK(count == 9);
+}
+
+TEST_CASE("files that aren't traces are rejected") {
+    const std::uint8_t garbage[32]{ 1, 2, 3 };
+    CHECK(!TraceDecoder(garbage, sizeof(garbage)).valid());
+}
+
+TEST_CASE("spsc ring refuses to overwrite unread items") {
+    SpscRing<int, 4> ring{};
+
+    for (int i = 0; i < 4; ++i) {
+        CHECK(ring.push(i));
+    }
+
+    CHECK(!ring.push(4));
+
+    int sum = 0;
+    CHECK(ring.drain([&](int v) { sum += v; }) == 4);
+    CHECK(sum == 6);
+
+    // indices keep counting past the capacity
+    for (int round = 0; round < 3; ++round) {
+        CHECK(ring.push(round));
+        CHECK(ring.drain([](int) {}) == 1);
+    }
+}
+
+TEST_CASE("recorder writes a trace that maps back in") {
+    const auto path = std::filesystem::temp_directory_path() / "autoscaler_tests" / "recorder.trace";
+    std::filesystem::remove(path);
+
+    {
+        TelemetryRecorder recorder{ path, std::chrono::milliseconds{ 5 } };
+
+        for (int i = 0; i < 500; ++i) {
+            recorder.record(make_record(i));
+        }
+
+        CHECK(recorder.dropped() == 0);
+    }
+
+    std::vector<TraceRecord> records{};
+    CHECK(read_trace(path, records));
+    CHECK(records.size() == 500);
+    CHECK(!records.empty() && same(records.back(), make_record(499)));
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("recorder moves on to a new file at the size limit and keeps the newest") {
+    const auto path = std::filesystem::temp_directory_path() / "autoscaler_tests" / "rotated.trace";
+    const auto segment_path = [&](int segment) {
+        return segment == 1 ? path : path.parent_path() / ("rotated-" + std::to_string(segment) + ".trace");
+    };
+
+    {
+        TelemetryRecorder recorder{ path, std::chrono::milliseconds{ 5 }, 2048, 2 };
+        CHECK(recorder.segment_path(3) == segment_path(3));
+
+        for (int i = 0; i < 3000; ++i) {
+            recorder.record(make_record(i));
+
+            // Spread over several flushes, the ring only holds so many
+            if (i % 500 == 499) {
+                std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
+            }
+        }
+    }
+
+    int files = 0;
+    std::filesystem::path newest{};
+
+    for (int segment = 1; segment < 100; ++segment) {
+        if (std::filesystem::exists(segment_path(segment))) {
+            ++files;
+            newest = segment_path(segment);
+        }
+    }
+
+    // Older files were removed, each one left reads back on its own
+    std::vector<TraceRecord> records{};
+    CHECK(files == 2);
+    CHECK(read_trace(newest, records));
+    CHECK(std::filesystem::file_size(newest) <= 2048 + 64);
+    CHECK(!records.empty() && same(records.back(), make_record(2999)));
+
+    for (int segment = 1; segment < 100; ++segment) {
+        std::filesystem::remove(segment_path(segment));
+    }
+}
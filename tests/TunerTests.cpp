@@ -0,0 +1,53 @@
+#include "autoscaler/Tuner.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+TuningCorpus small_corpus() {
+    TuningCorpus corpus{};
+
+    for (auto scenario : standard_scenarios()) {
+        if (scenario.name == "cold_start") {
+            scenario.seconds = 60.0;
+            corpus.add_scenario(scenario, 2);
+        }
+    }
+
+    return corpus;
+}
+}
+
+TEST_CASE("constrain keeps parameters in range and the band open") {
+    Settings settings{};
+    settings.usagelowerbound = 97;
+    settings.usageupperbound = 40;
+    settings.increaseframesrequired = 0;
+
+    constrain(settings);
+    CHECK(settings.usagelowerbound == 95);
+    CHECK(settings.usageupperbound == 97);
+    CHECK(settings.increaseframesrequired == 1);
+}
+
+TEST_CASE("tuning never returns worse than the start and ignores the pool size") {
+    const auto corpus = small_corpus();
+
+    TunerOptions options{};
+    options.strategy = SearchStrategy::Evolutionary;
+    options.budget = 24;
+    options.population = 8;
+
+    WorkPool one{ 1 };
+    WorkPool four{ 4 };
+
+    const auto a = tune(corpus, Settings{}, options, one);
+    const auto b = tune(corpus, Settings{}, options, four);
+
+    CHECK(a.evaluations >= options.budget);
+    CHECK(a.best.score >= a.start.score);
+    CHECK(a.best.score == b.best.score);
+    CHECK(a.best.settings.usagelowerbound == b.best.settings.usagelowerbound);
+    CHECK(a.best.settings.decreaseframesrequired == b.best.settings.decreaseframesrequired);
+}
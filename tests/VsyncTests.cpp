@@ -0,0 +1,62 @@
+#include "autoscaler/Random.hpp"
+#include "autoscaler/Vsync.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+namespace {
+// 90 Hz with a little jitter, every period-th frame taking two intervals
+void feed(VsyncDetector& detector, Random& random, int frames, int period) {
+    for (int i = 0; i < frames; ++i) {
+        const auto intervals = period > 0 && i % period == 0 ? 2 : 1;
+        detector.add(static_cast<float>((intervals * 1000.0 / 90.0 + 0.15 * random.gaussian()) / 1000.0));
+    }
+}
+}
+
+TEST_CASE("the refresh interval comes from where deltas bunch up") {
+    VsyncDetector detector{};
+    Random random{ 1 };
+
+    CHECK(detector.interval_ms() == 0.0);
+    feed(detector, random, 300, 10);
+
+    CHECK(detector.quantized());
+    CHECK_NEAR(detector.interval_ms(), 1000.0 / 90.0, 0.2);
+}
+
+TEST_CASE("each delta says how many refreshes it missed") {
+    VsyncDetector detector{};
+    Random random{ 2 };
+    feed(detector, random, 300, 0);
+
+    CHECK(detector.add(1.0f / 90.0f) == 0);
+    CHECK(detector.add(2.0f / 90.0f) == 1);
+    CHECK(detector.add(3.0f / 90.0f) == 2);
+    CHECK(detector.missed(1.0f) == 3);
+}
+
+TEST_CASE("mostly missed frames still leave the refresh as the interval") {
+    VsyncDetector detector{};
+    Random random{ 3 };
+    feed(detector, random, 300, 0);
+
+    // Every frame takes two intervals for a few seconds, as when the resolution is far too high
+    feed(detector, random, 300, 1);
+
+    CHECK_NEAR(detector.interval_ms(), 1000.0 / 90.0, 0.2);
+    CHECK(detector.missed(1.0f) >= 40);
+}
+
+TEST_CASE("deltas off any refresh grid count nothing as missed") {
+    VsyncDetector detector{};
+    Random random{ 4 };
+
+    // No vsync, frame time wanders between 6 and 14 ms
+    for (int i = 0; i < 1000; ++i) {
+        CHECK(detector.add(static_cast<float>(0.006 + 0.008 * random.uniform())) == 0);
+    }
+
+    CHECK(!detector.quantized());
+}
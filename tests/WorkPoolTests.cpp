@@ -0,0 +1,27 @@
+#include <atomic>
+
+#include "autoscaler/WorkPool.hpp"
+
+#include "Test.hpp"
+
+using namespace autoscaler;
+
+TEST_CASE("work pool runs every job exactly once, batch after batch") {
+    WorkPool pool{ 4 };
+    CHECK(pool.size() == 4);
+
+    for (size_t count : { size_t{ 1 }, size_t{ 3 }, size_t{ 1000 } }) {
+        std::vector<std::atomic<int>> runs(count);
+
+        pool.parallel_for(count, [&](size_t i) {
+            runs[i].fetch_add(1);
+        });
+
+        bool once = true;
+        for (const auto& r : runs) {
+            once = once && r.load() == 1;
+        }
+
+        CHECK(once);
+    }
+}
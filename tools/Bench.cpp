@@ -0,0 +1,206 @@
+// Scores controller settings on the standard simulator scenarios and on recorded traces,
+// and compares a candidate against a baseline.
+//
+//   autoscaler_bench [--baseline a.json] [--candidate b.json] [--set key=value] [--seeds 20]
+//                    [--plant plant.json] [--scenario load_spike] [--trace session.trace] ...
+//
+// Every scenario runs once per seed. Traces are cut into 60 second blocks which play the part
+// of seeds. Each metric gets a bootstrap confidence interval, and with a candidate the paired
+// difference (candidate - baseline) gets one too. A difference whose interval lies entirely on
+// the worse side is a regression, and any regression makes the exit code 1.
+// --set changes the candidate, or the baseline if there is no candidate yet. --plant runs the
+// scenarios on a plant file, e.g. one autoscaler_identify fitted to a game.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "autoscaler/Benchmark.hpp"
+
+using namespace autoscaler;
+
+namespace {
+bool load_json(const char* path, nlohmann::json& j) {
+    std::ifstream file(path);
+    j = nlohmann::json::parse(file, nullptr, false);
+
+    if (j.is_discarded()) {
+        std::fprintf(stderr, "Can't read %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+
+bool load_settings(const char* path, Settings& settings) {
+    nlohmann::json j;
+    if (!load_json(path, j)) {
+        return false;
+    }
+
+    apply_settings(j, settings);
+    return true;
+}
+
+std::vector<double> column(const std::vector<Scorecard>& cards, double Scorecard::*value) {
+    std::vector<double> values{};
+    values.reserve(cards.size());
+
+    for (const auto& card : cards) {
+        values.push_back(card.*value);
+    }
+
+    return values;
+}
+
+// Prints one block of metrics and returns how many of them regressed
+int report(const std::string& name, const std::vector<Scorecard>& baseline, const std::vector<Scorecard>* candidate) {
+    std::printf("%s (n=%zu)\n", name.c_str(), baseline.size());
+
+    if (candidate) {
+        std::printf("  %-16s%24s%24s%30s\n", "", "baseline", "candidate", "difference");
+    }
+
+    int regressions = 0;
+
+    for (const auto& metric : scorecard_metrics()) {
+        // shares read better as percentages
+        const auto scale = metric.value == &Scorecard::over_budget_share ? 100.0 : 1.0;
+        const auto base = bootstrap_mean(column(baseline, metric.value));
+
+        std::printf("  %-16s%8.2f [%6.2f,%6.2f]", metric.name, base.mean * scale, base.low * scale, base.high * scale);
+
+        if (candidate) {
+            const auto cand = bootstrap_mean(column(*candidate, metric.value));
+
+            std::vector<double> differences{};
+            for (size_t i = 0; i < baseline.size() && i < candidate->size(); ++i) {
+                differences.push_back((*candidate)[i].*metric.value - baseline[i].*metric.value);
+            }
+
+            const auto diff = bootstrap_mean(differences);
+            const auto worse = metric.higher_is_better ? diff.high < 0.0 : diff.low > 0.0;
+            const auto better = metric.higher_is_better ? diff.low > 0.0 : diff.high < 0.0;
+
+            std::printf("%8.2f [%6.2f,%6.2f]%+8.2f [%+7.2f,%+7.2f] %s", cand.mean * scale, cand.low * scale, cand.high * scale,
+                diff.mean * scale, diff.low * scale, diff.high * scale, worse ? "WORSE" : better ? "better" : "");
+
+            regressions += worse ? 1 : 0;
+        }
+
+        std::printf("\n");
+    }
+
+    std::printf("\n");
+    return regressions;
+}
+}
+
+int main(int argc, char** argv) {
+    Settings baseline{};
+    std::optional<Settings> candidate{};
+    PlantParams plant{};
+    int seeds = 20;
+    std::string only_scenario{};
+    std::vector<std::string> traces{};
+
+    for (int i = 1; i < argc; ++i) {
+        const auto has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--baseline") == 0 && has_value) {
+            if (!load_settings(argv[++i], baseline)) {
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--candidate") == 0 && has_value) {
+            candidate = baseline;
+            if (!load_settings(argv[++i], *candidate)) {
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--set") == 0 && has_value) {
+            const std::string assignment = argv[++i];
+            const auto equals = assignment.find('=');
+
+            if (equals == std::string::npos) {
+                std::fprintf(stderr, "--set expects key=value, got %s\n", assignment.c_str());
+                return 2;
+            }
+
+            nlohmann::json j;
+            auto value = nlohmann::json::parse(assignment.substr(equals + 1), nullptr, false);
+
+            // Lets strings go unquoted, e.g. controller=predictive
+            if (value.is_discarded()) {
+                value = assignment.substr(equals + 1);
+            }
+
+            j[assignment.substr(0, equals)] = value;
+            apply_settings(j, candidate ? *candidate : baseline);
+        }
+        else if (std::strcmp(argv[i], "--plant") == 0 && has_value) {
+            nlohmann::json j;
+            if (!load_json(argv[++i], j) || !apply_plant_params(j, plant)) {
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--seeds") == 0 && has_value) {
+            seeds = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--scenario") == 0 && has_value) {
+            only_scenario = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && has_value) {
+            traces.emplace_back(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    int regressions = 0;
+
+    for (const auto& scenario : standard_scenarios(plant)) {
+        if (!only_scenario.empty() && scenario.name != only_scenario) {
+            continue;
+        }
+
+        std::vector<Scorecard> base_cards{};
+        std::vector<Scorecard> cand_cards{};
+
+        // the same seeds for both, so the differences are paired
+        for (int seed = 1; seed <= seeds; ++seed) {
+            base_cards.push_back(run_scenario(scenario, baseline, seed));
+
+            if (candidate) {
+                cand_cards.push_back(run_scenario(scenario, *candidate, seed));
+            }
+        }
+
+        regressions += report(scenario.name, base_cards, candidate ? &cand_cards : nullptr);
+    }
+
+    for (const auto& path : traces) {
+        const MappedFile file{ path };
+        if (!file.is_open() || !TraceDecoder(file.data(), file.size()).valid()) {
+            std::fprintf(stderr, "Can't read trace %s\n", path.c_str());
+            return 2;
+        }
+
+        const auto base_cards = score_trace(file.data(), file.size(), baseline);
+        const auto cand_cards = candidate ? score_trace(file.data(), file.size(), *candidate) : std::vector<Scorecard>{};
+
+        regressions += report(path, base_cards, candidate ? &cand_cards : nullptr);
+    }
+
+    if (candidate) {
+        std::printf("%d regression%s\n", regressions, regressions == 1 ? "" : "s");
+    }
+
+    return regressions > 0 ? 1 : 0;
+}
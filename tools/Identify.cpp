@@ -0,0 +1,89 @@
+// Fits a simulator plant to recorded traces of one game.
+//
+//   autoscaler_identify session1.trace [session2.trace ...] [--out plant.json]
+//
+// Prints what it found and writes the plant, which autoscaler_simulate, autoscaler_bench and
+// autoscaler_tune take with --plant.
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "autoscaler/SystemId.hpp"
+#include "autoscaler/Trace.hpp"
+
+using namespace autoscaler;
+
+int main(int argc, char** argv) {
+    std::vector<std::string> traces{};
+    std::string out{};
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        }
+        else if (argv[i][0] == '-') {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+        else {
+            traces.emplace_back(argv[i]);
+        }
+    }
+
+    if (traces.empty()) {
+        std::fprintf(stderr, "usage: %s session.trace ... [--out plant.json]\n", argv[0]);
+        return 1;
+    }
+
+    PlantIdentifier identifier{};
+
+    for (const auto& path : traces) {
+        const MappedFile file{ path };
+
+        if (!file.is_open() || !identifier.add_trace(file.data(), file.size())) {
+            std::fprintf(stderr, "Can't read trace %s\n", path.c_str());
+            return 1;
+        }
+    }
+
+    const auto fit = identifier.fit();
+    const auto& params = fit.params;
+
+    if (fit.readings == 0) {
+        std::fprintf(stderr, "No usable sensor readings, was resolution ever changed?\n");
+        return 1;
+    }
+
+    std::printf("%d readings, R^2 %.3f\n\n", fit.readings, fit.r_squared);
+    std::printf("refresh             %8.2f Hz\n", params.refresh_hz);
+    std::printf("GPU at 100%%         %8.2f ms\n", params.gpu_ms_at_100);
+    std::printf("fixed GPU           %8.2f ms\n", params.fixed_gpu_ms);
+    std::printf("noise               %8.1f %%\n", params.noise * 100.0);
+    std::printf("sensor period       %8.1f ms\n", params.sensor_period * 1000.0);
+    std::printf("sensor delay        %8d frames\n", params.sensor_delay_frames);
+    std::printf("change hitch        %8.2f ms (%d changes)\n", params.change_hitch_ms, fit.changes);
+    std::printf("scene               %8zu segments\n", params.scene.size());
+
+    if (!fit.noise_spectrum.empty()) {
+        std::printf("\nresidual power by octave\n");
+
+        for (const auto& band : fit.noise_spectrum) {
+            std::printf("  %6.3f - %6.3f Hz  %5.1f %%\n", band.low_hz, band.high_hz, band.share * 100.0);
+        }
+    }
+
+    if (!out.empty()) {
+        std::ofstream file(out);
+        file << plant_params_to_json(params).dump(4) << '\n';
+
+        if (!file.good()) {
+            std::fprintf(stderr, "Can't write %s\n", out.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}
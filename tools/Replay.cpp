@@ -0,0 +1,158 @@
+// Replays a recorded trace through the controller with other settings and compares the results.
+//
+//   autoscaler_replay session.trace [--recorded played.json] [--config a.json] [--config b.json --set usagelowerbound=78] ...
+//
+// Every --config adds a column, --set key=value changes the most recent one (or the defaults).
+// Without any --config the trace is replayed with the default settings. Time in band is scored
+// against the band of --recorded, the config the session was played with, defaults if not given.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "autoscaler/Replay.hpp"
+
+using namespace autoscaler;
+
+namespace {
+struct Candidate {
+    std::string name;
+    Settings settings;
+};
+
+void print_row(const char* label, const std::vector<SessionStats>& columns, double (*get)(const SessionStats&), const char* format) {
+    std::printf("%-20s", label);
+
+    for (const auto& stats : columns) {
+        std::printf(format, get(stats));
+    }
+
+    std::printf("\n");
+}
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s session.trace [--recorded file] [--config file] [--set key=value] ...\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<Candidate> candidates{};
+    Settings recorded{};
+
+    for (int i = 2; i < argc; ++i) {
+        const auto has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--recorded") == 0 && has_value) {
+            std::ifstream file(argv[++i]);
+            const auto j = nlohmann::json::parse(file, nullptr, false);
+
+            if (j.is_discarded()) {
+                std::fprintf(stderr, "Can't read %s\n", argv[i]);
+                return 1;
+            }
+
+            apply_settings(j, recorded);
+        }
+        else if (std::strcmp(argv[i], "--config") == 0 && has_value) {
+            std::ifstream file(argv[++i]);
+            const auto j = nlohmann::json::parse(file, nullptr, false);
+
+            if (j.is_discarded()) {
+                std::fprintf(stderr, "Can't read %s\n", argv[i]);
+                return 1;
+            }
+
+            Candidate candidate{ std::filesystem::path(argv[i]).stem().string(), Settings{} };
+            apply_settings(j, candidate.settings);
+            candidates.push_back(candidate);
+        }
+        else if (std::strcmp(argv[i], "--set") == 0 && has_value) {
+            const std::string assignment = argv[++i];
+            const auto equals = assignment.find('=');
+
+            if (equals == std::string::npos) {
+                std::fprintf(stderr, "--set expects key=value, got %s\n", assignment.c_str());
+                return 1;
+            }
+
+            if (candidates.empty()) {
+                candidates.push_back({ "defaults", Settings{} });
+            }
+
+            // values go through the same JSON parsing as the config file
+            nlohmann::json j;
+            auto value = nlohmann::json::parse(assignment.substr(equals + 1), nullptr, false);
+
+            // Lets strings go unquoted, e.g. controller=predictive
+            if (value.is_discarded()) {
+                value = assignment.substr(equals + 1);
+            }
+
+            j[assignment.substr(0, equals)] = value;
+            apply_settings(j, candidates.back().settings);
+            candidates.back().name += " " + assignment;
+        }
+        else {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (candidates.empty()) {
+        candidates.push_back({ "defaults", Settings{} });
+    }
+
+    const MappedFile file{ argv[1] };
+    if (!file.is_open() || !TraceDecoder(file.data(), file.size()).valid()) {
+        std::fprintf(stderr, "Can't read trace %s\n", argv[1]);
+        return 1;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<SessionStats> columns{};
+    double refresh_interval = 0.0;
+
+    for (const auto& candidate : candidates) {
+        const auto result = replay_trace(file.data(), file.size(), candidate.settings, recorded);
+
+        if (columns.empty()) {
+            columns.push_back(result.recorded);
+        }
+
+        columns.push_back(result.replayed);
+        refresh_interval = result.refresh_interval;
+    }
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::printf("%s: %.1f s, %d ticks, refresh %.2f Hz, replayed in %.3f s\n", argv[1], columns[0].seconds, columns[0].frames,
+        refresh_interval > 0.0 ? 1.0 / refresh_interval : 0.0, elapsed);
+    std::printf("time in band is usage between %d%% and %d%%, as recorded\n\n", recorded.usagelowerbound, recorded.usageupperbound);
+
+    std::printf("%-20s%16s", "", "recorded");
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        std::printf("%16zu", i + 1);
+    }
+    std::printf("\n");
+
+    print_row("time in band %", columns, [](const SessionStats& s) { return s.time_in_band * 100.0; }, "%16.1f");
+    print_row("missed frames", columns, [](const SessionStats& s) { return static_cast<double>(s.missed_frames); }, "%16.0f");
+    print_row("mean resolution %", columns, [](const SessionStats& s) { return s.mean_screen_percentage; }, "%16.1f");
+    print_row("p5 resolution %", columns, [](const SessionStats& s) { return s.p5_screen_percentage; }, "%16.0f");
+    print_row("changes", columns, [](const SessionStats& s) { return static_cast<double>(s.changes); }, "%16.0f");
+    print_row("frame time sd ms", columns, [](const SessionStats& s) { return s.pacing.stddev_ms; }, "%16.2f");
+    print_row("longest stall ms", columns, [](const SessionStats& s) { return s.pacing.longest_ms; }, "%16.1f");
+    print_row("judder", columns, [](const SessionStats& s) { return s.pacing.judder; }, "%16.1f");
+
+    std::printf("\n");
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        std::printf("%zu: %s\n", i + 1, candidates[i].name.c_str());
+    }
+
+    return 0;
+}
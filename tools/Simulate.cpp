@@ -0,0 +1,131 @@
+// Runs the controller against the simulated GPU and prints how it did.
+//
+//   autoscaler_simulate [--seconds N] [--config autoscalerconfig.json] [--plant plant.json] [--csv frames.csv] [--trace run.trace]
+//
+// --config takes the same file the plugin reads, --plant a file of PlantParams as written by plant_params_to_json.
+// --trace writes the run in the plugin's telemetry format, so it can be fed to autoscaler_replay.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "autoscaler/Simulator.hpp"
+#include "autoscaler/Trace.hpp"
+
+using namespace autoscaler;
+
+namespace {
+bool load_json(const char* path, nlohmann::json& j) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::fprintf(stderr, "Can't open %s\n", path);
+        return false;
+    }
+
+    j = nlohmann::json::parse(file, nullptr, false);
+    if (j.is_discarded()) {
+        std::fprintf(stderr, "Can't parse %s\n", path);
+        return false;
+    }
+
+    return true;
+}
+}
+
+int main(int argc, char** argv) {
+    double seconds = 600.0;
+    Settings settings{};
+    PlantParams plant{};
+    const char* csv_path = nullptr;
+    const char* trace_path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        const auto has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--seconds") == 0 && has_value) {
+            seconds = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--config") == 0 && has_value) {
+            nlohmann::json j;
+            if (!load_json(argv[++i], j)) {
+                return 1;
+            }
+
+            apply_settings(j, settings);
+        }
+        else if (std::strcmp(argv[i], "--plant") == 0 && has_value) {
+            nlohmann::json j;
+            if (!load_json(argv[++i], j) || !apply_plant_params(j, plant)) {
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0 && has_value) {
+            csv_path = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && has_value) {
+            trace_path = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--seconds N] [--config file] [--plant file] [--csv file] [--trace file]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    std::ofstream csv{};
+    if (csv_path != nullptr) {
+        csv.open(csv_path);
+        csv << "time,delta,gpu_ms,intervals,screen_percentage,usage,action\n";
+    }
+
+    std::vector<std::uint8_t> trace{};
+    TraceEncoder encoder{};
+    if (trace_path != nullptr) {
+        trace = TraceEncoder::header();
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+
+    const auto stats = simulate(plant, settings, seconds, 50, [&](const SimFrame& frame, const Decision& decision) {
+        if (csv.is_open()) {
+            csv << frame.time << ',' << frame.delta << ',' << frame.gpu_ms << ',' << frame.intervals << ','
+                << frame.screen_percentage << ',' << frame.usage << ',' << static_cast<int>(decision.action) << '\n';
+        }
+
+        if (trace_path != nullptr) {
+            TraceRecord record{};
+            record.time_us = static_cast<std::int64_t>(frame.time * 1'000'000.0);
+            record.delta_us = static_cast<std::int64_t>(frame.delta * 1'000'000.0);
+            record.usage = decision.usage;
+            record.band = decision.band;
+            record.action = decision.action;
+            record.screen_percentage = decision.screen_percentage;
+            record.frame_p95_us = static_cast<std::int64_t>(decision.frame_p95_ms * 1000.0f);
+            record.frame_p99_us = static_cast<std::int64_t>(decision.frame_p99_ms * 1000.0f);
+            record.hitch = decision.hitch;
+            record.damping = decision.damping;
+            encoder.encode(record, trace);
+        }
+    });
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if (trace_path != nullptr) {
+        std::ofstream file(trace_path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(trace.data()), static_cast<std::streamsize>(trace.size()));
+
+        if (!file.good()) {
+            std::fprintf(stderr, "Can't write %s\n", trace_path);
+            return 1;
+        }
+    }
+
+    std::printf("simulated         %.1f s (%d frames) in %.3f s\n", stats.seconds, stats.frames, elapsed);
+    std::printf("missed intervals  %d (%.2f%%)\n", stats.missed_frames,
+        100.0 * stats.missed_frames / std::max(1, stats.frames + stats.missed_frames));
+    std::printf("changes           %d\n", stats.changes);
+    std::printf("mean resolution   %.1f%%\n", stats.mean_screen_percentage);
+    return 0;
+}
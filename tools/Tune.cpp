@@ -0,0 +1,189 @@
+// Searches controller settings against simulator scenarios and recorded traces, and writes the best
+// as a profile.
+//
+//   autoscaler_tune [--config start.json] [--strategy grid|random|evolve] [--budget 400] [--threads N]
+//                   [--seeds 5] [--plant plant.json] [--trace session.trace] ... [--traces-only]
+//                   [--missed-weight 1] [--megapixel-weight 1]
+//                   [--game Game-Win64-Shipping.exe] [--uevr v1.05] [--out profile.json]
+//
+// The search starts from --config (or the defaults). With --game the output is a profile store that
+// can be merged into autoscalerprofiles.json, otherwise it is an autoscalerconfig.json fragment.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "autoscaler/Tuner.hpp"
+
+using namespace autoscaler;
+
+int main(int argc, char** argv) {
+    Settings start{};
+    PlantParams plant{};
+    TunerOptions options{};
+    unsigned threads = 0;
+    int seeds = 5;
+    bool scenarios = true;
+    std::vector<std::string> traces{};
+    std::string game{};
+    std::string uevr{};
+    std::string out{};
+
+    for (int i = 1; i < argc; ++i) {
+        const auto has_value = i + 1 < argc;
+
+        if (std::strcmp(argv[i], "--config") == 0 && has_value) {
+            std::ifstream file(argv[++i]);
+            const auto j = nlohmann::json::parse(file, nullptr, false);
+
+            if (j.is_discarded()) {
+                std::fprintf(stderr, "Can't read %s\n", argv[i]);
+                return 1;
+            }
+
+            apply_settings(j, start);
+        }
+        else if (std::strcmp(argv[i], "--plant") == 0 && has_value) {
+            std::ifstream file(argv[++i]);
+            const auto j = nlohmann::json::parse(file, nullptr, false);
+
+            if (j.is_discarded() || !apply_plant_params(j, plant)) {
+                std::fprintf(stderr, "Can't read %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--strategy") == 0 && has_value) {
+            const std::string strategy = argv[++i];
+
+            if (strategy == "grid") {
+                options.strategy = SearchStrategy::Grid;
+            }
+            else if (strategy == "random") {
+                options.strategy = SearchStrategy::Random;
+            }
+            else if (strategy == "evolve") {
+                options.strategy = SearchStrategy::Evolutionary;
+            }
+            else {
+                std::fprintf(stderr, "Unknown strategy %s, expected grid, random or evolve\n", strategy.c_str());
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--budget") == 0 && has_value) {
+            options.budget = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--population") == 0 && has_value) {
+            options.population = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--grid-points") == 0 && has_value) {
+            options.grid_points = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && has_value) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && has_value) {
+            threads = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        }
+        else if (std::strcmp(argv[i], "--seeds") == 0 && has_value) {
+            seeds = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--trace") == 0 && has_value) {
+            traces.emplace_back(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--traces-only") == 0) {
+            scenarios = false;
+        }
+        else if (std::strcmp(argv[i], "--missed-weight") == 0 && has_value) {
+            options.objective.missed_weight = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--megapixel-weight") == 0 && has_value) {
+            options.objective.megapixel_weight = std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--game") == 0 && has_value) {
+            game = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--uevr") == 0 && has_value) {
+            uevr = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--out") == 0 && has_value) {
+            out = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "Unknown argument %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    TuningCorpus corpus{};
+
+    if (scenarios) {
+        for (const auto& scenario : standard_scenarios(plant)) {
+            corpus.add_scenario(scenario, seeds);
+        }
+    }
+
+    for (const auto& path : traces) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<std::uint8_t> data{ std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+
+        if (!TraceDecoder(data.data(), data.size()).valid()) {
+            std::fprintf(stderr, "Can't read trace %s\n", path.c_str());
+            return 1;
+        }
+
+        corpus.add_trace(std::move(data));
+    }
+
+    if (corpus.jobs() == 0) {
+        std::fprintf(stderr, "Nothing to tune against, --traces-only needs at least one --trace\n");
+        return 1;
+    }
+
+    WorkPool pool{ threads };
+    const auto started = std::chrono::steady_clock::now();
+
+    const auto result = tune(corpus, start, options, pool, [&](int evaluations, const Candidate& best) {
+        const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+        std::fprintf(stderr, "\r%d evaluated, best %.3f, %.1f/s   ", evaluations, best.score, evaluations / elapsed);
+    });
+
+    const auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::fprintf(stderr, "\n%d candidates x %zu runs on %u threads in %.1f s\n", result.evaluations, corpus.jobs(), pool.size(), elapsed);
+    std::fprintf(stderr, "score %.3f -> %.3f\n", result.start.score, result.best.score);
+
+    nlohmann::json profile{};
+
+    if (!game.empty()) {
+        profile["game"] = game;
+    }
+
+    if (!uevr.empty()) {
+        profile["uevr"] = uevr;
+    }
+
+    for (const auto& parameter : tuned_parameters()) {
+        profile[parameter.name] = result.best.settings.*parameter.value;
+    }
+
+    const auto document = game.empty() ? profile : nlohmann::json{ { "profiles", nlohmann::json::array({ profile }) } };
+
+    if (out.empty()) {
+        std::printf("%s\n", document.dump(4).c_str());
+    }
+    else {
+        std::ofstream file(out);
+        file << document.dump(4) << '\n';
+
+        if (!file.good()) {
+            std::fprintf(stderr, "Can't write %s\n", out.c_str());
+            return 1;
+        }
+    }
+
+    return 0;
+}